@@ -8,29 +8,289 @@
 
 #include <type_traits>
 #include <functional>
+#include <atomic>
+#include <thread>
 #include <mutex>
+#include <condition_variable>
 
 #include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
 #include <memory>
+#include <memory_resource>
 #include <tuple>
 #include <array>
-#include <map>
+#include <vector>
+#include <algorithm>
 #include <new>
 
-template <uint64_t L, uint64_t R>
-struct constexpr_mod
-{
-	static constexpr uint64_t value = L % R;
-};
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+// libstdc++ needs TBB behind std::execution::par, so StdParallelExecutor is opt in
+#if defined(ALC_STD_EXECUTION)
+#include <execution>
+#include <numeric>
+#endif
+
+// Stale handle detection in Handle::Resolve(), on by default in debug builds only
+#ifndef ALC_CHECK_HANDLES
+#ifdef NDEBUG
+#define ALC_CHECK_HANDLES 0
+#else
+#define ALC_CHECK_HANDLES 1
+#endif
+#endif
+
+// Allocator statistics, off unless asked for. Disabled counters are empty and compile away
+#ifndef ALC_STATS
+#define ALC_STATS 0
+#endif
+
+// Lets empty members (disabled counters) take no space, C++17 compilers take it as an extension
+#if defined(_MSC_VER)
+#define ALC_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#elif defined(__has_cpp_attribute)
+#if __has_cpp_attribute(no_unique_address)
+#define ALC_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+
+#ifndef ALC_NO_UNIQUE_ADDRESS
+#define ALC_NO_UNIQUE_ADDRESS
+#endif
 
 namespace Alc
 {
     class Allocator {};
 
+    static constexpr bool CheckHandles = ALC_CHECK_HANDLES != 0;
+    static constexpr bool CollectStats = ALC_STATS != 0;
+
+    ////////////////////////////////////////////////
+    // Bit helpers
+    namespace Bits
+    {
+        static constexpr uint64_t WordBits = 64U;
+
+        // Index of the lowest set bit, word must not be zero
+        [[nodiscard]] inline auto CountTrailingZeros(uint64_t word) noexcept -> uint64_t
+        {
+#if defined(_MSC_VER)
+            unsigned long index = 0U;
+            _BitScanForward64(&index, word);
+            return index;
+#else
+            return static_cast<uint64_t>(__builtin_ctzll(word));
+#endif
+        }
+
+        // Index of the highest set bit counted from the top, word must not be zero
+        [[nodiscard]] inline auto CountLeadingZeros(uint64_t word) noexcept -> uint64_t
+        {
+#if defined(_MSC_VER)
+            unsigned long index = 0U;
+            _BitScanReverse64(&index, word);
+            return 63U - index;
+#else
+            return static_cast<uint64_t>(__builtin_clzll(word));
+#endif
+        }
+
+        [[nodiscard]] inline auto PopCount(uint64_t word) noexcept -> uint64_t
+        {
+#if defined(_MSC_VER)
+            return __popcnt64(word);
+#else
+            return static_cast<uint64_t>(__builtin_popcountll(word));
+#endif
+        }
+
+        // Number of 64 bit LUT words needed to track capacity slots, the last one may be partial
+        [[nodiscard]] constexpr auto LutWords(uint64_t capacity) noexcept -> uint64_t
+        {
+            return (capacity + WordBits - 1U) / WordBits;
+        }
+
+        [[nodiscard]] constexpr auto LutBytes(uint64_t capacity) noexcept -> uint64_t
+        {
+            return LutWords(capacity) * sizeof(uint64_t);
+        }
+
+        // One past the highest set bit of a LUT, loadWord(w) reads word w
+        template<typename LoadWord>
+        [[nodiscard]] auto ActiveSpan(uint64_t lutWords, LoadWord&& loadWord) -> uint64_t
+        {
+            for (uint64_t w = lutWords; w-- > 0U;)
+            {
+                if (const uint64_t word = loadWord(w))
+                    return w * WordBits + WordBits - CountLeadingZeros(word);
+            }
+
+            return 0U;
+        }
+    }
+
+    ////////////////////////////////////////////////
+    // Stats
+    //  Snapshot of one pool, or one size class of a heap. Only live, capacity and
+    //  fragmentation are filled in without ALC_STATS, the counters read zero
+    struct AllocatorStats
+    {
+        uint64_t live               = 0U;
+        uint64_t peak               = 0U;
+        uint64_t capacity           = 0U;
+        uint64_t allocations        = 0U;
+        uint64_t frees              = 0U;
+        uint64_t failedAllocations  = 0U;
+        uint64_t reallocations      = 0U;
+        uint64_t scannedWords       = 0U;
+        uint64_t lockContentions    = 0U;
+
+        // Share of the slots below the highest live one that are free, 0 when packed
+        double fragmentation        = 0.0;
+
+        [[nodiscard]] static auto Fragmentation(uint64_t live, uint64_t span) noexcept -> double
+        {
+            return span != 0U ? 1.0 - static_cast<double>(live) / static_cast<double>(span) : 0.0;
+        }
+
+        // emit(name, value) once per field, for whatever the metrics pipeline expects
+        template<typename Emit>
+        void Export(Emit&& emit) const
+        {
+            emit("live", live);
+            emit("peak", peak);
+            emit("capacity", capacity);
+            emit("allocations", allocations);
+            emit("frees", frees);
+            emit("failed_allocations", failedAllocations);
+            emit("reallocations", reallocations);
+            emit("scanned_words", scannedWords);
+            emit("lock_contentions", lockContentions);
+            emit("fragmentation", fragmentation);
+        }
+    };
+
+    // Relaxed counters bumped on the hot paths
+    template<bool Enabled = CollectStats>
+    class StatsCounters
+    {
+    public:
+        void OnAlloc(uint64_t count = 1U) noexcept
+        {
+            const uint64_t live = m_Live.fetch_add(count, std::memory_order_relaxed) + count;
+            uint64_t peak = m_Peak.load(std::memory_order_relaxed);
+
+            while (live > peak && !m_Peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            {
+            }
+
+            m_Allocations.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        void OnFree(uint64_t count = 1U) noexcept
+        {
+            m_Live.fetch_sub(count, std::memory_order_relaxed);
+            m_Frees.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        void OnFailed() noexcept { m_Failed.fetch_add(1U, std::memory_order_relaxed); }
+        void OnReallocate() noexcept { m_Reallocations.fetch_add(1U, std::memory_order_relaxed); }
+        void OnScan(uint64_t words) noexcept { m_ScannedWords.fetch_add(words, std::memory_order_relaxed); }
+        void OnContention() noexcept { m_Contentions.fetch_add(1U, std::memory_order_relaxed); }
+
+        void Fill(AllocatorStats& stats) const noexcept
+        {
+            stats.live              = m_Live.load(std::memory_order_relaxed);
+            stats.peak              = m_Peak.load(std::memory_order_relaxed);
+            stats.allocations       = m_Allocations.load(std::memory_order_relaxed);
+            stats.frees             = m_Frees.load(std::memory_order_relaxed);
+            stats.failedAllocations = m_Failed.load(std::memory_order_relaxed);
+            stats.reallocations     = m_Reallocations.load(std::memory_order_relaxed);
+            stats.scannedWords      = m_ScannedWords.load(std::memory_order_relaxed);
+            stats.lockContentions   = m_Contentions.load(std::memory_order_relaxed);
+        }
+
+        // Takes the lock, counting the times someone else already held it
+        [[nodiscard]] auto Lock(std::mutex& mutex) -> std::unique_lock<std::mutex>
+        {
+            std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+
+            if (!lock.owns_lock())
+            {
+                OnContention();
+                lock.lock();
+            }
+
+            return lock;
+        }
+
+    private:
+        std::atomic<uint64_t> m_Live{ 0U };
+        std::atomic<uint64_t> m_Peak{ 0U };
+        std::atomic<uint64_t> m_Allocations{ 0U };
+        std::atomic<uint64_t> m_Frees{ 0U };
+        std::atomic<uint64_t> m_Failed{ 0U };
+        std::atomic<uint64_t> m_Reallocations{ 0U };
+        std::atomic<uint64_t> m_ScannedWords{ 0U };
+        std::atomic<uint64_t> m_Contentions{ 0U };
+    };
+
+    template<>
+    class StatsCounters<false>
+    {
+    public:
+        void OnAlloc(uint64_t = 1U) noexcept {}
+        void OnFree(uint64_t = 1U) noexcept {}
+        void OnFailed() noexcept {}
+        void OnReallocate() noexcept {}
+        void OnScan(uint64_t) noexcept {}
+        void OnContention() noexcept {}
+        void Fill(AllocatorStats&) const noexcept {}
+
+        [[nodiscard]] auto Lock(std::mutex& mutex) -> std::unique_lock<std::mutex> { return std::unique_lock<std::mutex>(mutex); }
+    };
+
+    // Indexable like the enabled array, hands out empty counters
+    struct NoStatsArray
+    {
+        [[nodiscard]] auto operator[](uint64_t) const noexcept -> StatsCounters<false> { return {}; }
+    };
+
+    // One counter set per size class, nothing at all when disabled
+    template<bool Enabled, uint64_t Count>
+    using StatsArray = std::conditional_t<Enabled, std::array<StatsCounters<true>, Count>, NoStatsArray>;
+
     struct PoolAllocator
     {
     public:
         [[nodiscard]] constexpr virtual auto Internal() noexcept -> void* = 0;
+
+        // Address of the element at index, pools that aren't one contiguous block override this
+        [[nodiscard]] virtual auto Resolve(uint64_t index) noexcept -> void* = 0;
     };
 
     ////////////////////////////////////////////////
@@ -45,420 +305,5166 @@ namespace Alc
         {
         }
 
-        OffsetPtr(PoolAllocator* pPool, uint64_t elementOffset)
-            : pContainer(pPool)
-            , offset(elementOffset)
+        OffsetPtr(PoolAllocator* pPool, uint64_t elementOffset)
+            : pContainer(pPool)
+            , offset(elementOffset)
+        {
+        }
+
+        // Helpers
+        [[nodiscard]] constexpr auto Internal() noexcept -> uint64_t { return offset; }
+        [[nodiscard]] constexpr auto Container() noexcept -> PoolAllocator* { return pContainer; }
+
+        constexpr void ZeroOut() noexcept
+        {
+            offset = 0U;
+            pContainer = nullptr;
+        }
+
+        // Resolving
+        [[nodiscard]] auto Resolve() noexcept -> Type* { return static_cast<Type*>(pContainer->Resolve(offset)); }
+        Type* operator->() noexcept { return static_cast<Type*>(pContainer->Resolve(offset)); }
+
+    private:
+        uint64_t offset;
+        PoolAllocator *pContainer;
+    };
+
+    template<typename Type>
+    using OPtr = OffsetPtr<Type>;
+
+    ////////////////////////////////////////////////
+    // HandleTable
+    //  Global table of pool base addresses, lets a Handle resolve with one load and an add
+    //  instead of a virtual call. Pools publish their new base whenever they move, along with
+    //  their per slot generation counters
+    class HandleTable
+    {
+    public:
+        using Generation = std::atomic<uint16_t>;
+
+        static constexpr uint32_t MaxPools      = 4096U;
+        static constexpr uint32_t InvalidPool   = 0xFFFFU;
+
+        // The top ids are never handed out by Register(), see SharedPool
+        static constexpr uint32_t SharedPools       = 256U;
+        static constexpr uint32_t FirstSharedPool   = MaxPools - SharedPools;
+
+        [[nodiscard]] static auto Register(void *pBase, Generation *pGenerations) -> uint32_t
+        {
+            std::lock_guard<std::mutex> guard(s_Mutex);
+            uint32_t id = s_NextId;
+
+            if (!s_FreeIds.empty())
+            {
+                id = s_FreeIds.back();
+                s_FreeIds.pop_back();
+            }
+            else if (s_NextId == FirstSharedPool)
+                throw std::bad_alloc();
+            else
+                s_NextId++;
+
+            Publish(id, pBase, pGenerations);
+            return id;
+        }
+
+        static void Publish(uint32_t id, void *pBase, Generation *pGenerations) noexcept
+        {
+            s_Generations[id].store(pGenerations, std::memory_order_release);
+            s_Bases[id].store(pBase, std::memory_order_release);
+        }
+
+        // Fixed ids for pools in shared memory, every process attaching the segment takes the
+        //  same one so a Handle means the same slot everywhere
+        [[nodiscard]] static auto RegisterShared(uint32_t id, void *pBase, Generation *pGenerations) -> uint32_t
+        {
+            std::lock_guard<std::mutex> guard(s_Mutex);
+
+            if (id < FirstSharedPool || id >= MaxPools || Base(id))
+                throw std::out_of_range("Shared pool id is out of range or already registered in this process...");
+
+            Publish(id, pBase, pGenerations);
+            return id;
+        }
+
+        static void Release(uint32_t id)
+        {
+            std::lock_guard<std::mutex> guard(s_Mutex);
+            Publish(id, nullptr, nullptr);
+
+            if (id < FirstSharedPool)
+                s_FreeIds.push_back(id);
+        }
+
+        [[nodiscard]] static auto Base(uint32_t id) noexcept -> void*
+        {
+            return s_Bases[id].load(std::memory_order_acquire);
+        }
+
+        // Current generation of a slot, only valid for registered ids
+        [[nodiscard]] static auto GenerationOf(uint32_t id, uint32_t index) noexcept -> uint16_t
+        {
+            return s_Generations[id].load(std::memory_order_acquire)[index].load(std::memory_order_relaxed);
+        }
+
+    private:
+        static inline std::array<std::atomic<void*>, MaxPools> s_Bases{};
+        static inline std::array<std::atomic<Generation*>, MaxPools> s_Generations{};
+        static inline std::vector<uint32_t> s_FreeIds{};
+        static inline uint32_t s_NextId = 0U;
+        static inline std::mutex s_Mutex{};
+    };
+
+    ////////////////////////////////////////////////
+    // Handle
+    //  8 byte alternative to OffsetPtr, 32 bit element index, 16 bit HandleTable pool id and
+    //  the 16 bit generation of the slot when the handle was made. Popping a slot bumps its
+    //  generation so every other copy of the handle goes stale
+    template<typename Type>
+    class Handle
+    {
+    public:
+        Handle()
+            : index(0U)
+            , poolId(static_cast<uint16_t>(HandleTable::InvalidPool))
+            , generation(0U)
+        {
+        }
+
+        Handle(uint32_t pool, uint32_t elementIndex, uint16_t slotGeneration)
+            : index(elementIndex)
+            , poolId(static_cast<uint16_t>(pool))
+            , generation(slotGeneration)
+        {
+        }
+
+        // Helpers
+        [[nodiscard]] constexpr auto Internal() const noexcept -> uint32_t { return index; }
+        [[nodiscard]] constexpr auto PoolId() const noexcept -> uint32_t { return poolId; }
+        [[nodiscard]] constexpr auto Generation() const noexcept -> uint16_t { return generation; }
+
+        constexpr void ZeroOut() noexcept
+        {
+            index = 0U;
+            poolId = static_cast<uint16_t>(HandleTable::InvalidPool);
+            generation = 0U;
+        }
+
+        // Resolving, stale handles throw when CheckHandles is on and resolve blindly otherwise
+        [[nodiscard]] auto Resolve() const noexcept(!CheckHandles) -> Type*
+        {
+            if constexpr (CheckHandles)
+            {
+                if (poolId >= HandleTable::MaxPools || HandleTable::GenerationOf(poolId, index) != generation)
+                    throw std::out_of_range("Stale handle, its slot was popped...");
+            }
+
+            return static_cast<Type*>(HandleTable::Base(poolId)) + index;
+        }
+
+        Type* operator->() const noexcept(!CheckHandles) { return Resolve(); }
+
+    private:
+        uint32_t index;
+        uint16_t poolId;
+        uint16_t generation;
+    };
+
+    ////////////////////////////////////////////////
+    // AlignedAllocator
+    //  Heap backed aligned blocks, _aligned_malloc on Windows and posix_memalign elsewhere
+    class AlignedAllocator
+        : public Allocator
+    {
+    public:
+        static constexpr uint64_t CacheLineSize = 64U;
+
+        // Rounded up to a power of two of at least pointer size, any element size can be passed
+        [[nodiscard]] static constexpr auto NormalizeAlignment(uint64_t alignment) noexcept -> uint64_t
+        {
+            uint64_t normalized = sizeof(void*);
+
+            while (normalized < alignment)
+                normalized *= 2U;
+
+            return normalized;
+        }
+
+        // Contents are left as they are, see AllocZeroed()
+        [[nodiscard]] static auto Alloc(size_t size, uint64_t alignment = CacheLineSize) -> void*
+        {
+            const uint64_t alnm = NormalizeAlignment(alignment);
+
+#if defined(_WIN32)
+            void *pMem = _aligned_malloc(size, alnm);
+#else
+            void *pMem = nullptr;
+            if (posix_memalign(&pMem, alnm, size) != 0)
+                pMem = nullptr;
+#endif
+            if (!pMem)
+                throw std::bad_alloc();
+
+            return pMem;
+        }
+
+        [[nodiscard]] static auto AllocZeroed(size_t size, uint64_t alignment = CacheLineSize) -> void*
+        {
+            void *pMem = Alloc(size, alignment);
+            std::memset(pMem, 0, size);
+            return pMem;
+        }
+
+        static void Dealloc(void *pPtr)
+        {
+#if defined(_WIN32)
+            _aligned_free(pPtr);
+#else
+            free(pPtr);
+#endif
+        }
+    };
+
+    ////////////////////////////////////////////////
+    // PageOptions
+    //  Placement of page backed memory, used by VirtualMemory, PageAllocator and VirtualPool
+    enum class HugePages : uint8_t
+    {
+        None,
+        Transparent,    // Hint only, the OS backs the range with 2MB pages when it can
+        Explicit        // Reserved huge pages (MAP_HUGETLB / MEM_LARGE_PAGES), falls back to Transparent
+    };
+
+    struct PageOptions
+    {
+        HugePages hugePages = HugePages::None;
+        int32_t numaNode    = -1;   // -1 leaves placement to the OS
+    };
+
+    ////////////////////////////////////////////////
+    // VirtualMemory
+    //  Address space reservation with explicit page commit / decommit
+    class VirtualMemory
+        : public Allocator
+    {
+    public:
+        [[nodiscard]] static auto PageSize() noexcept -> uint64_t
+        {
+#if defined(_WIN32)
+            SYSTEM_INFO info{};
+            GetSystemInfo(&info);
+            return info.dwPageSize;
+#else
+            return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+        }
+
+        [[nodiscard]] static auto RoundToPage(uint64_t bytes) noexcept -> uint64_t
+        {
+            const uint64_t page = PageSize();
+            return (bytes + page - 1U) / page * page;
+        }
+
+        static constexpr uint64_t HugePageSize = 2U * 1024U * 1024U;
+
+        // Node the calling thread is running on, -1 when the OS can't tell
+        [[nodiscard]] static auto CurrentNumaNode() noexcept -> int32_t
+        {
+#if defined(_WIN32)
+            PROCESSOR_NUMBER processor{};
+            USHORT node = 0U;
+            GetCurrentProcessorNumberEx(&processor);
+            return GetNumaProcessorNodeEx(&processor, &node) ? static_cast<int32_t>(node) : -1;
+#elif defined(__linux__) && defined(SYS_getcpu)
+            unsigned cpu = 0U;
+            unsigned node = 0U;
+            return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<int32_t>(node) : -1;
+#else
+            return -1;
+#endif
+        }
+
+        // Inaccessible until committed, costs no physical memory. Huge page and node hints are
+        //  applied to the whole range up front so every later commit inherits them
+        [[nodiscard]] static auto Reserve(uint64_t bytes, const PageOptions& options = {}) -> void*
+        {
+#if defined(_WIN32)
+            (void)options;
+            void *pMem = VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+            void *pMem = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (pMem == MAP_FAILED)
+                pMem = nullptr;
+            else
+                Advise(pMem, bytes, options);
+#endif
+            if (!pMem)
+                throw std::bad_alloc();
+
+            return pMem;
+        }
+
+        // Committed pages read as zero
+        static void Commit(void *pMem, uint64_t bytes, const PageOptions& options = {})
+        {
+#if defined(_WIN32)
+            void *pCommitted = options.numaNode >= 0
+                ? VirtualAllocExNuma(GetCurrentProcess(), pMem, bytes, MEM_COMMIT, PAGE_READWRITE, static_cast<DWORD>(options.numaNode))
+                : VirtualAlloc(pMem, bytes, MEM_COMMIT, PAGE_READWRITE);
+
+            if (!pCommitted)
+                throw std::bad_alloc();
+#else
+            (void)options;
+
+            if (mprotect(pMem, bytes, PROT_READ | PROT_WRITE) != 0)
+                throw std::bad_alloc();
+#endif
+        }
+
+        // Hands the physical pages back, the range stays reserved
+        static void Decommit(void *pMem, uint64_t bytes)
+        {
+#if defined(_WIN32)
+            VirtualFree(pMem, bytes, MEM_DECOMMIT);
+#else
+            madvise(pMem, bytes, MADV_DONTNEED);
+            mprotect(pMem, bytes, PROT_NONE);
+#endif
+        }
+
+        static void Release(void *pMem, uint64_t bytes)
+        {
+#if defined(_WIN32)
+            (void)bytes;
+            VirtualFree(pMem, 0, MEM_RELEASE);
+#else
+            munmap(pMem, bytes);
+#endif
+        }
+
+#if !defined(_WIN32)
+        // Best effort, a kernel without THP or NUMA support just ignores these
+        static void Advise(void *pMem, uint64_t bytes, const PageOptions& options) noexcept
+        {
+#if defined(MADV_HUGEPAGE)
+            if (options.hugePages != HugePages::None)
+                madvise(pMem, bytes, MADV_HUGEPAGE);
+#endif
+#if defined(__linux__) && defined(SYS_mbind)
+            constexpr uint64_t MaskWords = 16U;
+            constexpr uint64_t BitsPerWord = sizeof(unsigned long) * 8U;
+            constexpr int BindPolicy = 2; // MPOL_BIND
+
+            if (options.numaNode >= 0 && static_cast<uint64_t>(options.numaNode) < MaskWords * BitsPerWord)
+            {
+                unsigned long nodeMask[MaskWords] = {};
+                nodeMask[options.numaNode / BitsPerWord] |= 1UL << (options.numaNode % BitsPerWord);
+                syscall(SYS_mbind, pMem, bytes, BindPolicy, nodeMask, MaskWords * BitsPerWord, 0U);
+            }
+#endif
+            (void)pMem;
+            (void)bytes;
+            (void)options;
+        }
+#endif
+    };
+
+    ////////////////////////////////////////////////
+    // PageAllocator
+    //  Committed page blocks straight from the OS, for big pools that want huge pages or a
+    //  NUMA node. Dealloc() needs the same size and options the block was allocated with
+    class PageAllocator
+        : public Allocator
+    {
+    public:
+        [[nodiscard]] static auto MappedBytes(uint64_t bytes, const PageOptions& options) noexcept -> uint64_t
+        {
+            if (options.hugePages == HugePages::None)
+                return VirtualMemory::RoundToPage(bytes);
+
+            return (bytes + VirtualMemory::HugePageSize - 1U) / VirtualMemory::HugePageSize * VirtualMemory::HugePageSize;
+        }
+
+        // Pages read as zero
+        [[nodiscard]] static auto Alloc(uint64_t bytes, const PageOptions& options = {}) -> void*
+        {
+            const uint64_t mapped = MappedBytes(bytes, options);
+
+#if defined(_WIN32)
+            const DWORD node = options.numaNode >= 0 ? static_cast<DWORD>(options.numaNode) : NUMA_NO_PREFERRED_NODE;
+            void *pMem = nullptr;
+
+            // Needs SeLockMemoryPrivilege and a size that is a multiple of the large page size
+            if (options.hugePages == HugePages::Explicit && GetLargePageMinimum() != 0U && mapped % GetLargePageMinimum() == 0U)
+                pMem = VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapped, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+
+            if (!pMem)
+                pMem = VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapped, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+#else
+            void *pMem = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+            if (options.hugePages == HugePages::Explicit)
+                pMem = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+            if (pMem == MAP_FAILED)
+                pMem = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (pMem == MAP_FAILED)
+                pMem = nullptr;
+            else
+                VirtualMemory::Advise(pMem, mapped, options);
+#endif
+            if (!pMem)
+                throw std::bad_alloc();
+
+            return pMem;
+        }
+
+        static void Dealloc(void *pMem, uint64_t bytes, const PageOptions& options = {})
+        {
+            VirtualMemory::Release(pMem, MappedBytes(bytes, options));
+        }
+
+        // Block source of Pool and SegmentedPool, plain aligned memory unless options ask for
+        //  huge pages or a NUMA node. A block goes back with the bytes and options it came with
+        [[nodiscard]] static auto Placed(const PageOptions& options) noexcept -> bool
+        {
+            return options.hugePages != HugePages::None || options.numaNode >= 0;
+        }
+
+        [[nodiscard]] static auto AllocPoolBlock(uint64_t bytes, const PageOptions& options) -> void*
+        {
+            return Placed(options) ? Alloc(bytes, options) : AlignedAllocator::Alloc(bytes);
+        }
+
+        static void DeallocPoolBlock(void *pBlock, uint64_t bytes, const PageOptions& options)
+        {
+            if (!pBlock)
+                return;
+
+            if (Placed(options))
+                Dealloc(pBlock, bytes, options);
+            else
+                AlignedAllocator::Dealloc(pBlock);
+        }
+    };
+
+    // Backings and allocators built with it start empty and take their first block on first use
+    struct Unallocated {};
+
+    struct Pool
+        : public PoolAllocator, public Allocator
+    {
+        // Reallocate() moves every object
+        static constexpr bool StableAddresses = false;
+        static constexpr bool Contiguous = true;
+        static constexpr bool Persistent = false;
+        static constexpr bool ProcessShared = false;
+
+        union
+        {
+            void *pLut;
+            void *pPoolBlockStart;
+        };
+
+        void *pMem              = nullptr;
+        uint64_t capacity       = 0U;
+        uint64_t poolItemSize   = 0U;
+
+        // Written by every Get() / Pop(), kept off the line that resolving an OffsetPtr reads
+        alignas(AlignedAllocator::CacheLineSize) uint64_t size = 0U;
+
+        // Where blocks come from, only read when the pool (re)allocates
+        PageOptions pageOptions{};
+
+        // LUT bytes rounded up to a cache line, objects start on a line of their own
+        [[nodiscard]] static constexpr auto LutSpan(uint64_t poolCapacity) noexcept -> uint64_t
+        {
+            return (Bits::LutBytes(poolCapacity) + AlignedAllocator::CacheLineSize - 1U) / AlignedAllocator::CacheLineSize * AlignedAllocator::CacheLineSize;
+        }
+
+        Pool()
+        {
+            capacity        = 0U;
+            size            = 0U;
+            poolItemSize    = 0U;
+            pLut            = nullptr;
+            pMem            = nullptr;
+        }
+
+        // Nothing allocated yet, the first Grow() takes minCapacity as it is. Constant
+        //  initializable, a static one has no construction order to get wrong
+        constexpr Pool(uint64_t elementSize, Unallocated) noexcept
+            : pLut(nullptr)
+            , poolItemSize(elementSize)
+        {
+        }
+
+        // Huge pages or a NUMA node in options take each block straight from PageAllocator
+        explicit Pool(uint64_t elementSize, uint64_t poolCapacity = 1024U, const PageOptions& options = {})
+        {
+            pageOptions     = options;
+            poolItemSize    = elementSize;
+
+            // Only the LUT starts zeroed, object memory is left to fault in lazily and Get() builds each object
+            void *pMemory = PageAllocator::AllocPoolBlock(BlockBytes(poolCapacity), pageOptions);
+            std::memset(pMemory, 0, Bits::LutBytes(poolCapacity));
+
+            capacity        = poolCapacity;
+            size            = 0U;
+            pLut            = pMemory;
+            pMem            = static_cast<uint8_t*>(pMemory) + LutSpan(poolCapacity);
+        }
+
+        void Reallocate(uint64_t minCapacity = 0U)
+        {
+            const uint64_t oldCapacity = capacity;
+            ReleaseBlock(Grow(minCapacity), oldCapacity);
+        }
+
+        // Grows like Reallocate but hands the old block back instead of freeing it,
+        //  for callers that can't free it until readers are done with it. ReleaseBlock()
+        //  frees it later, given the capacity the pool had before
+        [[nodiscard]] auto Grow(uint64_t minCapacity = 0U) -> void*
+        {
+            void *pOldBlock     = pPoolBlockStart;
+            void *pOldMem       = pMem;
+            uint64_t oldCapacity = capacity;
+
+            // Duplicate capacity, keep doubling if a batch needs more than that
+            capacity = capacity == 0U ? std::max<uint64_t>(minCapacity, 1U) : capacity * 2U;
+
+            while (capacity < minCapacity)
+                capacity *= 2;
+
+            // Reallocate and assign accordingly
+            void *pNewMemory = PageAllocator::AllocPoolBlock(BlockBytes(capacity), pageOptions);
+
+            pLut = pNewMemory;
+            pMem = static_cast<uint8_t*>(pNewMemory) + LutSpan(capacity);
+
+            // Copy over old LUT, unused bits of a partial last word are zero so they stay free.
+            //  Only the new LUT words are cleared, the object tail is never touched here
+            if (oldCapacity != 0U)
+                std::memcpy(pPoolBlockStart, pOldBlock, Bits::LutBytes(oldCapacity));
+
+            std::memset(static_cast<uint8_t*>(pPoolBlockStart) + Bits::LutBytes(oldCapacity), 0, Bits::LutBytes(capacity) - Bits::LutBytes(oldCapacity));
+
+            // Copy over old pool
+            if (oldCapacity != 0U)
+                std::memcpy(pMem, pOldMem, poolItemSize * oldCapacity);
+
+            return pOldBlock;
+        }
+
+        void ReleaseBlock(void *pBlock, uint64_t blockCapacity)
+        {
+            PageAllocator::DeallocPoolBlock(pBlock, BlockBytes(blockCapacity), pageOptions);
+        }
+
+        [[nodiscard]] auto BlockBytes(uint64_t blockCapacity) const noexcept -> uint64_t
+        {
+            return LutSpan(blockCapacity) + poolItemSize * blockCapacity;
+        }
+
+        [[nodiscard]] constexpr auto Internal() noexcept -> void* override { return pMem; };
+        [[nodiscard]] auto Resolve(uint64_t index) noexcept -> void* override { return static_cast<uint8_t*>(pMem) + index * poolItemSize; }
+        [[nodiscard]] auto Lut() noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut); }
+
+        // Backing interface shared with SegmentedPool
+        [[nodiscard]] auto LutWord(uint64_t w) noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut) + w; }
+        [[nodiscard]] auto ContiguousSlots() const noexcept -> uint64_t { return capacity; }
+
+        template<typename Type>
+        [[nodiscard]] auto At(uint64_t index) noexcept -> Type* { return static_cast<Type*>(pMem) + index; }
+
+        // Exchanges blocks, lets a new block be filled object by object and then take over
+        void Swap(Pool& other) noexcept
+        {
+            std::swap(pLut, other.pLut);
+            std::swap(pMem, other.pMem);
+            std::swap(capacity, other.capacity);
+            std::swap(size, other.size);
+            std::swap(poolItemSize, other.poolItemSize);
+            std::swap(pageOptions, other.pageOptions);
+        }
+
+        ~Pool()
+        {
+            ReleaseBlock(pPoolBlockStart, capacity);
+        }
+
+    private:
+        Pool(const Pool& other)
+        {
+            pLut            = other.pLut;
+            pPoolBlockStart = other.pPoolBlockStart;
+            pMem            = other.pMem;
+            capacity        = other.capacity;
+            size            = other.size;
+            poolItemSize    = other.poolItemSize;
+            pageOptions     = other.pageOptions;
+        }
+    };
+
+    ////////////////////////////////////////////////
+    // SegmentedPool
+    //  Grows by appending fixed size chunks instead of reallocating, each chunk carries its
+    //  own LUT words in front of its objects. Nothing is ever copied, so objects keep their
+    //  address and a Type* from OffsetPtr::Resolve() survives growth
+    struct SegmentedPool
+        : public PoolAllocator, public Allocator
+    {
+        static constexpr bool StableAddresses = true;
+        static constexpr bool Contiguous = false;
+        static constexpr bool Persistent = false;
+        static constexpr bool ProcessShared = false;
+
+        uint64_t capacity       = 0U;
+        uint64_t poolItemSize   = 0U;
+
+        // Same split as Pool, the counter gets a line of its own
+        alignas(AlignedAllocator::CacheLineSize) uint64_t size = 0U;
+
+        // Chunk capacity is rounded up to a power of two of at least one LUT word,
+        //  index to chunk is then a shift and a mask. options place every chunk like Pool's blocks
+        explicit SegmentedPool(uint64_t elementSize, uint64_t chunkCapacity = 1024U, const PageOptions& options = {})
+            : m_PageOptions(options)
+        {
+            while ((1ULL << m_ChunkShift) < chunkCapacity)
+                m_ChunkShift++;
+
+            poolItemSize    = elementSize;
+            m_ChunkMask     = (1ULL << m_ChunkShift) - 1U;
+            m_LutBytes      = Pool::LutSpan(1ULL << m_ChunkShift);
+
+            AppendChunk();
+        }
+
+        SegmentedPool(const SegmentedPool&) = delete;
+        SegmentedPool& operator=(const SegmentedPool&) = delete;
+
+        void Reallocate(uint64_t minCapacity = 0U)
+        {
+            AlignedAllocator::Dealloc(Grow(minCapacity));
+        }
+
+        // Appends at least one chunk, there is never an old block to hand back
+        [[nodiscard]] auto Grow(uint64_t minCapacity = 0U) -> void*
+        {
+            do
+                AppendChunk();
+            while (capacity < minCapacity);
+
+            return nullptr;
+        }
+
+        // Only the first chunk is reachable from here, use Resolve() / At() for the rest
+        [[nodiscard]] auto Internal() noexcept -> void* override { return Chunk(0U) + m_LutBytes; }
+
+        [[nodiscard]] auto Resolve(uint64_t index) noexcept -> void* override
+        {
+            return Chunk(index >> m_ChunkShift) + m_LutBytes + (index & m_ChunkMask) * poolItemSize;
+        }
+
+        [[nodiscard]] auto LutWord(uint64_t w) noexcept -> uint64_t*
+        {
+            const uint64_t wordShift = m_ChunkShift - 6U;
+            return reinterpret_cast<uint64_t*>(Chunk(w >> wordShift)) + (w & ((1ULL << wordShift) - 1U));
+        }
+
+        [[nodiscard]] auto ContiguousSlots() const noexcept -> uint64_t { return m_ChunkMask + 1U; }
+
+        template<typename Type>
+        [[nodiscard]] auto At(uint64_t index) noexcept -> Type*
+        {
+            return reinterpret_cast<Type*>(Chunk(index >> m_ChunkShift) + m_LutBytes) + (index & m_ChunkMask);
+        }
+
+        [[nodiscard]] auto ChunkCount() const noexcept -> uint64_t { return m_ChunkCount; }
+
+        // Frees whole chunks past newCapacity slots, the caller guarantees nothing lives there
+        void Shrink(uint64_t newCapacity)
+        {
+            const uint64_t chunkCapacity = m_ChunkMask + 1U;
+            const uint64_t keep = std::max<uint64_t>((newCapacity + chunkCapacity - 1U) / chunkCapacity, 1U);
+            uint8_t **pChunks = m_pChunks.load(std::memory_order_relaxed);
+
+            for (; m_ChunkCount > keep; --m_ChunkCount)
+                PageAllocator::DeallocPoolBlock(pChunks[m_ChunkCount - 1U], ChunkBytes(), m_PageOptions);
+
+            capacity = m_ChunkCount * chunkCapacity;
+        }
+
+        ~SegmentedPool()
+        {
+            uint8_t **pChunks = m_pChunks.load(std::memory_order_relaxed);
+
+            for (uint64_t i = 0; i < m_ChunkCount; ++i)
+                PageAllocator::DeallocPoolBlock(pChunks[i], ChunkBytes(), m_PageOptions);
+
+            delete[] pChunks;
+
+            for (uint8_t **pTable : m_RetiredTables)
+                delete[] pTable;
+        }
+
+    private:
+        [[nodiscard]] auto Chunk(uint64_t chunk) const noexcept -> uint8_t*
+        {
+            return m_pChunks.load(std::memory_order_acquire)[chunk];
+        }
+
+        [[nodiscard]] auto ChunkBytes() const noexcept -> uint64_t
+        {
+            return m_LutBytes + poolItemSize * (m_ChunkMask + 1U);
+        }
+
+        void AppendChunk()
+        {
+            uint8_t **pChunks = m_pChunks.load(std::memory_order_relaxed);
+
+            // Chunk table is full, publish a bigger copy. The old one stays readable for
+            //  anyone resolving concurrently and is freed with the pool
+            if (m_ChunkCount == m_TableCapacity)
+            {
+                m_TableCapacity = std::max<uint64_t>(m_TableCapacity * 2U, 8U);
+
+                auto pTable = new uint8_t*[m_TableCapacity];
+                std::copy(pChunks, pChunks + m_ChunkCount, pTable);
+
+                if (pChunks)
+                    m_RetiredTables.push_back(pChunks);
+
+                m_pChunks.store(pTable, std::memory_order_release);
+                pChunks = pTable;
+            }
+
+            uint8_t *pChunk = static_cast<uint8_t*>(PageAllocator::AllocPoolBlock(ChunkBytes(), m_PageOptions));
+            std::memset(pChunk, 0, m_LutBytes);
+
+            pChunks[m_ChunkCount++] = pChunk;
+
+            capacity += m_ChunkMask + 1U;
+        }
+
+        // Read by every Resolve(), starts past the size line
+        alignas(AlignedAllocator::CacheLineSize) std::atomic<uint8_t**> m_pChunks{ nullptr };
+        uint64_t m_ChunkCount       = 0U;
+        uint64_t m_TableCapacity    = 0U;
+        uint64_t m_ChunkShift       = 6U;
+        uint64_t m_ChunkMask        = 0U;
+        uint64_t m_LutBytes         = 0U;
+        std::vector<uint8_t**> m_RetiredTables{};
+        PageOptions m_PageOptions{};
+    };
+
+    ////////////////////////////////////////////////
+    // VirtualPool
+    //  Reserves address space for the largest capacity it may ever reach, LUT and objects
+    //  in two separate ranges, and commits pages as it grows. pMem never changes, growth
+    //  never copies, and Trim() decommits the tail after a load spike
+    struct VirtualPool
+        : public PoolAllocator, public Allocator
+    {
+        static constexpr bool StableAddresses = true;
+        static constexpr bool Contiguous = true;
+        static constexpr bool Persistent = false;
+        static constexpr bool ProcessShared = false;
+        static constexpr uint64_t DefaultReserveBytes = 1ULL << 34U;
+
+        void *pLut              = nullptr;
+        void *pMem              = nullptr;
+        uint64_t capacity       = 0U;
+        uint64_t poolItemSize   = 0U;
+        uint64_t maxCapacity    = 0U;
+
+        // Same split as Pool, the counter gets a line of its own
+        alignas(AlignedAllocator::CacheLineSize) uint64_t size = 0U;
+
+        // options apply to the whole reservation, e.g. transparent huge pages on a big pool
+        //  or the NUMA node of the worker that owns it
+        explicit VirtualPool(uint64_t elementSize, uint64_t poolCapacity = 1024U, uint64_t reserveBytes = DefaultReserveBytes, const PageOptions& options = {})
+            : m_Options(options)
+        {
+            poolItemSize    = elementSize;
+            maxCapacity     = std::max(poolCapacity, reserveBytes * 8U / (elementSize * 8U + 1U));
+
+            m_LutReserved   = VirtualMemory::RoundToPage(Bits::LutBytes(maxCapacity));
+            m_MemReserved   = VirtualMemory::RoundToPage(maxCapacity * elementSize);
+            m_MinCapacity   = poolCapacity;
+
+            pLut = VirtualMemory::Reserve(m_LutReserved + m_MemReserved, m_Options);
+            pMem = static_cast<uint8_t*>(pLut) + m_LutReserved;
+
+            CommitUpTo(poolCapacity);
+        }
+
+        VirtualPool(const VirtualPool&) = delete;
+        VirtualPool& operator=(const VirtualPool&) = delete;
+
+        void Reallocate(uint64_t minCapacity = 0U)
+        {
+            AlignedAllocator::Dealloc(Grow(minCapacity));
+        }
+
+        // Commits enough pages to at least double capacity, nothing moves
+        [[nodiscard]] auto Grow(uint64_t minCapacity = 0U) -> void*
+        {
+            if (capacity == maxCapacity)
+                throw std::bad_alloc();
+
+            CommitUpTo(std::min(std::max(capacity * 2U, minCapacity), maxCapacity));
+            return nullptr;
+        }
+
+        // Decommits every page past the highest active slot, never below the initial capacity
+        void Trim()
+        {
+            uint64_t highest = 0U;
+
+            for (uint64_t w = Bits::LutWords(capacity); w > 0U; --w)
+            {
+                const uint64_t word = static_cast<uint64_t*>(pLut)[w - 1U];
+
+                if (word != 0U)
+                {
+                    highest = (w - 1U) * Bits::WordBits + (Bits::WordBits - 1U);
+                    while (!(word & (1ULL << (highest % Bits::WordBits))))
+                        highest--;
+
+                    highest++;
+                    break;
+                }
+            }
+
+            Shrink(highest);
+        }
+
+        // Decommits pages past newCapacity slots, the caller guarantees nothing lives there
+        void Shrink(uint64_t newCapacity)
+        {
+            const uint64_t memBytes = VirtualMemory::RoundToPage(std::max(newCapacity, m_MinCapacity) * poolItemSize);
+            const uint64_t lutBytes = VirtualMemory::RoundToPage(Bits::LutBytes(memBytes / poolItemSize));
+
+            if (memBytes < m_MemCommitted)
+                VirtualMemory::Decommit(static_cast<uint8_t*>(pMem) + memBytes, m_MemCommitted - memBytes);
+
+            if (lutBytes < m_LutCommitted)
+                VirtualMemory::Decommit(static_cast<uint8_t*>(pLut) + lutBytes, m_LutCommitted - lutBytes);
+
+            m_MemCommitted  = std::min(m_MemCommitted, memBytes);
+            m_LutCommitted  = std::min(m_LutCommitted, lutBytes);
+            capacity        = std::min(capacity, m_MemCommitted / poolItemSize);
+        }
+
+        [[nodiscard]] constexpr auto Internal() noexcept -> void* override { return pMem; };
+        [[nodiscard]] auto Resolve(uint64_t index) noexcept -> void* override { return static_cast<uint8_t*>(pMem) + index * poolItemSize; }
+        [[nodiscard]] auto Lut() noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut); }
+
+        [[nodiscard]] auto LutWord(uint64_t w) noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut) + w; }
+        [[nodiscard]] auto ContiguousSlots() const noexcept -> uint64_t { return capacity; }
+
+        template<typename Type>
+        [[nodiscard]] auto At(uint64_t index) noexcept -> Type* { return static_cast<Type*>(pMem) + index; }
+
+        [[nodiscard]] auto CommittedBytes() const noexcept -> uint64_t { return m_LutCommitted + m_MemCommitted; }
+
+        ~VirtualPool()
+        {
+            VirtualMemory::Release(pLut, m_LutReserved + m_MemReserved);
+        }
+
+    private:
+        // Capacity ends up at whatever the committed object pages hold, which may be a bit more
+        void CommitUpTo(uint64_t slots)
+        {
+            const uint64_t memBytes = std::min(VirtualMemory::RoundToPage(slots * poolItemSize), m_MemReserved);
+            const uint64_t newCapacity = std::min(memBytes / poolItemSize, maxCapacity);
+            const uint64_t lutBytes = VirtualMemory::RoundToPage(Bits::LutBytes(newCapacity));
+
+            if (lutBytes > m_LutCommitted)
+                VirtualMemory::Commit(static_cast<uint8_t*>(pLut) + m_LutCommitted, lutBytes - m_LutCommitted, m_Options);
+
+            if (memBytes > m_MemCommitted)
+                VirtualMemory::Commit(static_cast<uint8_t*>(pMem) + m_MemCommitted, memBytes - m_MemCommitted, m_Options);
+
+            m_LutCommitted  = std::max(m_LutCommitted, lutBytes);
+            m_MemCommitted  = std::max(m_MemCommitted, memBytes);
+            capacity        = newCapacity;
+        }
+
+        PageOptions m_Options{};
+        uint64_t m_LutReserved  = 0U;
+        uint64_t m_MemReserved  = 0U;
+        uint64_t m_LutCommitted = 0U;
+        uint64_t m_MemCommitted = 0U;
+        uint64_t m_MinCapacity  = 0U;
+    };
+
+    ////////////////////////////////////////////////
+    // Snapshots
+    //  A contiguous pool written out as header, LUT and objects, each part on its own page.
+    //  Objects are only reachable by index (OffsetPtr), so mapping a snapshot back in needs
+    //  no fixups. Whatever Type holds must be as position independent as the pool itself
+    struct SnapshotHeader
+    {
+        static constexpr uint64_t Magic     = 0x0050414E53434C41ULL; // "ALCSNAP"
+        static constexpr uint64_t Version   = 1U;
+        static constexpr uint64_t Alignment = 4096U;
+
+        uint64_t magic          = Magic;
+        uint64_t version        = Version;
+        uint64_t elementSize    = 0U;
+        uint64_t capacity       = 0U;
+        uint64_t size           = 0U;
+        uint64_t lutOffset      = 0U;
+        uint64_t memOffset      = 0U;
+        uint64_t fileBytes      = 0U;
+
+        [[nodiscard]] static constexpr auto Align(uint64_t bytes) noexcept -> uint64_t
+        {
+            return (bytes + Alignment - 1U) / Alignment * Alignment;
+        }
+
+        [[nodiscard]] static constexpr auto Layout(uint64_t elementSize, uint64_t capacity, uint64_t size) noexcept -> SnapshotHeader
+        {
+            SnapshotHeader header{};
+            header.elementSize  = elementSize;
+            header.capacity     = capacity;
+            header.size         = size;
+            header.lutOffset    = Align(sizeof(SnapshotHeader));
+            header.memOffset    = header.lutOffset + Align(Bits::LutBytes(capacity));
+            header.fileBytes    = header.memOffset + Align(elementSize * capacity);
+            return header;
+        }
+
+        // True when the offsets are the ones Layout() gives for this header and everything
+        //  they point at lies inside mappedBytes. Capacity is bounded first so nothing overflows
+        [[nodiscard]] auto Fits(uint64_t mappedBytes) const noexcept -> bool
+        {
+            if (elementSize == 0U || capacity > mappedBytes / elementSize || size > capacity)
+                return false;
+
+            const SnapshotHeader expected = Layout(elementSize, capacity, size);
+
+            return lutOffset == expected.lutOffset && memOffset == expected.memOffset
+                && fileBytes == expected.fileBytes && fileBytes <= mappedBytes;
+        }
+    };
+
+    // Shared writes go back to the file. CopyOnWrite maps it privately, replicas share the
+    //  clean pages and only pay for the ones they write
+    enum class MapMode
+    {
+        Shared,
+        CopyOnWrite
+    };
+
+    // Pool, VirtualPool or MappedPool. Object pages past the last live slot are left as a hole
+    template<typename Backing>
+    void SaveSnapshot(const char *path, Backing& pool)
+    {
+        static_assert(Backing::Contiguous, "Snapshots are one LUT and one object block");
+
+        const SnapshotHeader header = SnapshotHeader::Layout(pool.poolItemSize, pool.capacity, pool.size);
+        const uint64_t span = Bits::ActiveSpan(Bits::LutWords(pool.capacity), [&pool](uint64_t w) { return *pool.LutWord(w); });
+
+        std::FILE *pFile = std::fopen(path, "wb");
+
+        if (!pFile)
+            throw std::runtime_error("Could not open snapshot file for writing...");
+
+        // Seeking past the end leaves holes that read as zero
+        const auto write = [pFile](uint64_t offset, const void *pData, uint64_t bytes)
+        {
+#if defined(_WIN32)
+            const bool seeked = _fseeki64(pFile, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+            const bool seeked = fseeko(pFile, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+            return seeked && std::fwrite(pData, 1U, bytes, pFile) == bytes;
+        };
+
+        const uint8_t zero = 0U;
+
+        bool written = write(0U, &header, sizeof(SnapshotHeader))
+            && write(header.lutOffset, pool.pLut, Bits::LutBytes(pool.capacity))
+            && write(header.memOffset, pool.pMem, span * pool.poolItemSize)
+            && write(header.fileBytes - 1U, &zero, 1U);
+
+        written = (std::fclose(pFile) == 0) && written;
+
+        if (!written)
+            throw std::runtime_error("Could not write snapshot file...");
+    }
+
+    ////////////////////////////////////////////////
+    // MappedPool
+    //  Backing pool living in a snapshot file, opening it is a page in rather than a
+    //  rebuild. A missing file is created with poolCapacity free slots in Shared mode.
+    //  The mapping can't grow, the pool keeps the capacity the snapshot was saved with
+    struct MappedPool
+        : public PoolAllocator, public Allocator
+    {
+        static constexpr bool StableAddresses = true;
+        static constexpr bool Contiguous = true;
+        static constexpr bool Persistent = true;
+        static constexpr bool ProcessShared = false;
+
+        void *pLut              = nullptr;
+        void *pMem              = nullptr;
+        uint64_t capacity       = 0U;
+        uint64_t poolItemSize   = 0U;
+
+        // Same split as Pool, the counter gets a line of its own
+        alignas(AlignedAllocator::CacheLineSize) uint64_t size = 0U;
+
+        MappedPool(uint64_t elementSize, uint64_t poolCapacity, const char *path, MapMode mode = MapMode::Shared)
+            : m_Mode(mode)
+        {
+            const SnapshotHeader fresh = SnapshotHeader::Layout(elementSize, poolCapacity, 0U);
+
+            Map(path, fresh.fileBytes);
+
+            SnapshotHeader *pHeader = Header();
+
+            // A new file reads as zeros, it gets its header and an empty LUT that way
+            if (pHeader->magic == 0U && m_MappedBytes == fresh.fileBytes)
+                *pHeader = fresh;
+
+            if (pHeader->magic != SnapshotHeader::Magic || pHeader->version != SnapshotHeader::Version
+                || pHeader->elementSize != elementSize)
+            {
+                Unmap();
+                throw std::runtime_error("Snapshot file does not hold a pool of this element type...");
+            }
+
+            // Truncated or corrupt, the LUT or the objects would reach past the mapping
+            if (!pHeader->Fits(m_MappedBytes))
+            {
+                Unmap();
+                throw std::runtime_error("Snapshot file layout does not fit the file...");
+            }
+
+            pLut            = static_cast<uint8_t*>(m_pMapping) + pHeader->lutOffset;
+            pMem            = static_cast<uint8_t*>(m_pMapping) + pHeader->memOffset;
+            capacity        = pHeader->capacity;
+            size            = pHeader->size;
+            poolItemSize    = elementSize;
+        }
+
+        MappedPool(const MappedPool&) = delete;
+        MappedPool& operator=(const MappedPool&) = delete;
+
+        [[noreturn]] void Reallocate(uint64_t = 0U)
+        {
+            throw std::bad_alloc();
+        }
+
+        [[noreturn]] auto Grow(uint64_t = 0U) -> void*
+        {
+            throw std::bad_alloc();
+        }
+
+        [[nodiscard]] constexpr auto Internal() noexcept -> void* override { return pMem; };
+        [[nodiscard]] auto Resolve(uint64_t index) noexcept -> void* override { return static_cast<uint8_t*>(pMem) + index * poolItemSize; }
+        [[nodiscard]] auto Lut() noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut); }
+
+        [[nodiscard]] auto LutWord(uint64_t w) noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut) + w; }
+        [[nodiscard]] auto ContiguousSlots() const noexcept -> uint64_t { return capacity; }
+
+        template<typename Type>
+        [[nodiscard]] auto At(uint64_t index) noexcept -> Type* { return static_cast<Type*>(pMem) + index; }
+
+        [[nodiscard]] auto Mode() const noexcept -> MapMode { return m_Mode; }
+
+        // Writes the live count back and pushes dirty pages to the file, Shared mode only
+        void Flush()
+        {
+            if (m_Mode != MapMode::Shared)
+                return;
+
+            Header()->size = size;
+
+#if defined(_WIN32)
+            FlushViewOfFile(m_pMapping, 0);
+#else
+            msync(m_pMapping, m_MappedBytes, MS_SYNC);
+#endif
+        }
+
+        ~MappedPool()
+        {
+            if (m_Mode == MapMode::Shared)
+                Header()->size = size;
+
+            Unmap();
+        }
+
+    private:
+        [[nodiscard]] auto Header() noexcept -> SnapshotHeader* { return static_cast<SnapshotHeader*>(m_pMapping); }
+
+        // Shared mode creates the file at createBytes when it doesn't exist yet
+        void Map(const char *path, uint64_t createBytes)
+        {
+            const bool shared = m_Mode == MapMode::Shared;
+
+#if defined(_WIN32)
+            HANDLE file = CreateFileA(path, shared ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+                shared ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::runtime_error("Could not open snapshot file...");
+
+            LARGE_INTEGER fileSize{};
+            GetFileSizeEx(file, &fileSize);
+
+            if (fileSize.QuadPart == 0 && shared)
+            {
+                fileSize.QuadPart = static_cast<LONGLONG>(createBytes);
+                SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN);
+                SetEndOfFile(file);
+            }
+
+            HANDLE mapping = fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, shared ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+            m_pMapping = mapping ? MapViewOfFile(mapping, shared ? FILE_MAP_ALL_ACCESS : FILE_MAP_COPY, 0, 0, 0) : nullptr;
+            m_MappedBytes = static_cast<uint64_t>(fileSize.QuadPart);
+
+            // The view keeps both alive
+            if (mapping)
+                CloseHandle(mapping);
+
+            CloseHandle(file);
+#else
+            const int fd = open(path, shared ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+
+            if (fd < 0)
+                throw std::runtime_error("Could not open snapshot file...");
+
+            struct stat info{};
+            fstat(fd, &info);
+
+            if (info.st_size == 0 && shared && ftruncate(fd, static_cast<off_t>(createBytes)) == 0)
+                info.st_size = static_cast<off_t>(createBytes);
+
+            m_MappedBytes = static_cast<uint64_t>(info.st_size);
+            m_pMapping = m_MappedBytes >= sizeof(SnapshotHeader)
+                ? mmap(nullptr, m_MappedBytes, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE, fd, 0)
+                : MAP_FAILED;
+
+            // The mapping keeps the file alive
+            close(fd);
+
+            if (m_pMapping == MAP_FAILED)
+                m_pMapping = nullptr;
+#endif
+            if (!m_pMapping || m_MappedBytes < sizeof(SnapshotHeader))
+            {
+                Unmap();
+                throw std::runtime_error("Could not map snapshot file...");
+            }
+        }
+
+        void Unmap() noexcept
+        {
+            if (!m_pMapping)
+                return;
+
+#if defined(_WIN32)
+            UnmapViewOfFile(m_pMapping);
+#else
+            munmap(m_pMapping, m_MappedBytes);
+#endif
+            m_pMapping = nullptr;
+        }
+
+        MapMode m_Mode          = MapMode::Shared;
+        void *m_pMapping        = nullptr;
+        uint64_t m_MappedBytes  = 0U;
+    };
+
+    ////////////////////////////////////////////////
+    // SharedPool
+    //  Backing pool in a named shared memory segment (shm_open, a named mapping on Windows)
+    //  or in a shareable fd such as a memfd passed to a child. Every attached process claims
+    //  and releases slots through the lock free CAS path on the shared LUT, so the allocator
+    //  over it must be LockFree and can't grow. OffsetPtr holds a process local pointer,
+    //  across processes use Handle, segmentId maps to a HandleTable id every process resolves
+    //  to its own mapping. A POSIX segment stays around until Unlink(), a Windows one goes
+    //  away with the last process that has it mapped
+    struct SharedPool
+        : public PoolAllocator, public Allocator
+    {
+        static constexpr bool StableAddresses = true;
+        static constexpr bool Contiguous = true;
+        static constexpr bool Persistent = true;
+        static constexpr bool ProcessShared = true;
+
+    private:
+        struct Layout
+        {
+            uint64_t elementSize    = 0U;
+            uint64_t capacity       = 0U;
+            uint64_t segmentId      = 0U;
+            uint64_t lutOffset      = 0U;
+            uint64_t genOffset      = 0U;
+            uint64_t memOffset      = 0U;
+            uint64_t totalBytes     = 0U;
+        };
+
+        // The creator publishes magic last, attachers wait on it
+        struct Header
+        {
+            static constexpr uint64_t Magic     = 0x00004D4853434C41ULL; // "ALCSHM"
+            static constexpr uint64_t Version   = 1U;
+
+            std::atomic<uint64_t> magic;
+            uint64_t version;
+            Layout layout;
+
+            alignas(AlignedAllocator::CacheLineSize) uint64_t size;
+        };
+
+        struct Mapping
+        {
+            Header *pHeader = nullptr;
+            uint64_t bytes  = 0U;
+        };
+
+        // Attached before anything below binds to it
+        Mapping m_Mapping{};
+
+    public:
+        void *pLut              = nullptr;
+        void *pMem              = nullptr;
+        uint64_t capacity       = 0U;
+        uint64_t poolItemSize   = 0U;
+
+        // Lives in the segment on a line of its own, every process counts against the same total
+        uint64_t &size;
+
+        // The first process to get here creates the segment with poolCapacity slots, the
+        //  rest attach to it. Every one of them passes the same capacity and segmentId
+        SharedPool(uint64_t elementSize, uint64_t poolCapacity, const char *name, uint32_t segmentId)
+            : m_Mapping(Open(name, MakeLayout(elementSize, poolCapacity, segmentId)))
+            , size(m_Mapping.pHeader->size)
+        {
+            Bind();
+        }
+
+#if !defined(_WIN32)
+        // A fresh (empty) fd gets sized and set up, one that already holds a pool is attached
+        SharedPool(uint64_t elementSize, uint64_t poolCapacity, int fd, uint32_t segmentId)
+            : m_Mapping(Adopt(fd, MakeLayout(elementSize, poolCapacity, segmentId)))
+            , size(m_Mapping.pHeader->size)
+        {
+            Bind();
+        }
+#endif
+
+        SharedPool(const SharedPool&) = delete;
+        SharedPool& operator=(const SharedPool&) = delete;
+
+        [[noreturn]] void Reallocate(uint64_t = 0U)
+        {
+            throw std::bad_alloc();
+        }
+
+        [[noreturn]] auto Grow(uint64_t = 0U) -> void*
+        {
+            throw std::bad_alloc();
+        }
+
+        [[nodiscard]] constexpr auto Internal() noexcept -> void* override { return pMem; };
+        [[nodiscard]] auto Resolve(uint64_t index) noexcept -> void* override { return static_cast<uint8_t*>(pMem) + index * poolItemSize; }
+        [[nodiscard]] auto Lut() noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut); }
+
+        [[nodiscard]] auto LutWord(uint64_t w) noexcept -> uint64_t* { return static_cast<uint64_t*>(pLut) + w; }
+        [[nodiscard]] auto ContiguousSlots() const noexcept -> uint64_t { return capacity; }
+
+        template<typename Type>
+        [[nodiscard]] auto At(uint64_t index) noexcept -> Type* { return static_cast<Type*>(pMem) + index; }
+
+        // Per slot generations live in the segment too, a Pop() in one process stales handles in all
+        [[nodiscard]] auto Generations() noexcept -> HandleTable::Generation*
+        {
+            return reinterpret_cast<HandleTable::Generation*>(reinterpret_cast<uint8_t*>(m_Mapping.pHeader) + m_Mapping.pHeader->layout.genOffset);
+        }
+
+        [[nodiscard]] auto SharedId() const noexcept -> uint32_t
+        {
+            return HandleTable::FirstSharedPool + static_cast<uint32_t>(m_Mapping.pHeader->layout.segmentId);
+        }
+
+        // Removes the name, processes that are attached keep their mapping
+        static void Unlink(const char *name) noexcept
+        {
+#if defined(_WIN32)
+            (void)name;
+#else
+            shm_unlink(name);
+#endif
+        }
+
+        ~SharedPool()
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(m_Mapping.pHeader);
+#else
+            munmap(m_Mapping.pHeader, m_Mapping.bytes);
+#endif
+        }
+
+    private:
+        [[nodiscard]] static auto MakeLayout(uint64_t elementSize, uint64_t poolCapacity, uint32_t segmentId) -> Layout
+        {
+            static_assert(std::atomic<uint64_t>::is_always_lock_free && HandleTable::Generation::is_always_lock_free, "Shared atomics must not hide a process local lock");
+
+            if (segmentId >= HandleTable::SharedPools)
+                throw std::out_of_range("segmentId past HandleTable::SharedPools...");
+
+            Layout layout{};
+            layout.elementSize  = elementSize;
+            layout.capacity     = poolCapacity;
+            layout.segmentId    = segmentId;
+            layout.lutOffset    = SnapshotHeader::Align(sizeof(Header));
+            layout.genOffset    = layout.lutOffset + SnapshotHeader::Align(Bits::LutBytes(poolCapacity));
+            layout.memOffset    = layout.genOffset + SnapshotHeader::Align(poolCapacity * sizeof(HandleTable::Generation));
+            layout.totalBytes   = layout.memOffset + SnapshotHeader::Align(poolCapacity * elementSize);
+            return layout;
+        }
+
+        void Bind() noexcept
+        {
+            const Layout &layout = m_Mapping.pHeader->layout;
+
+            pLut            = reinterpret_cast<uint8_t*>(m_Mapping.pHeader) + layout.lutOffset;
+            pMem            = reinterpret_cast<uint8_t*>(m_Mapping.pHeader) + layout.memOffset;
+            capacity        = layout.capacity;
+            poolItemSize    = layout.elementSize;
+        }
+
+        // Fresh segments read as zero, so only the header needs writing
+        [[nodiscard]] static auto Join(void *pMapping, uint64_t bytes, const Layout& wanted, bool creating) -> Mapping
+        {
+            Mapping mapping{ static_cast<Header*>(pMapping), bytes };
+            Header *pHeader = mapping.pHeader;
+
+            if (creating)
+            {
+                pHeader->version    = Header::Version;
+                pHeader->layout     = wanted;
+                pHeader->magic.store(Header::Magic, std::memory_order_release);
+            }
+            else
+            {
+                while (pHeader->magic.load(std::memory_order_acquire) == 0U)
+                    std::this_thread::yield();
+            }
+
+            if (pHeader->magic.load(std::memory_order_relaxed) != Header::Magic || pHeader->version != Header::Version
+                || pHeader->layout.elementSize != wanted.elementSize || pHeader->layout.segmentId != wanted.segmentId
+                || pHeader->layout.capacity != wanted.capacity || pHeader->layout.totalBytes != wanted.totalBytes
+                || pHeader->layout.totalBytes > bytes)
+            {
+#if defined(_WIN32)
+                UnmapViewOfFile(pMapping);
+#else
+                munmap(pMapping, bytes);
+#endif
+                throw std::runtime_error("Shared memory segment does not hold this pool...");
+            }
+
+            return mapping;
+        }
+
+#if defined(_WIN32)
+        [[nodiscard]] static auto Open(const char *name, const Layout& layout) -> Mapping
+        {
+            HANDLE section = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(layout.totalBytes >> 32U), static_cast<DWORD>(layout.totalBytes), name);
+            const bool creating = section && GetLastError() != ERROR_ALREADY_EXISTS;
+
+            void *pMapping = section ? MapViewOfFile(section, FILE_MAP_ALL_ACCESS, 0, 0, 0) : nullptr;
+
+            // The view keeps the section alive
+            if (section)
+                CloseHandle(section);
+
+            if (!pMapping)
+                throw std::runtime_error("Could not map shared memory segment...");
+
+            MEMORY_BASIC_INFORMATION info{};
+            VirtualQuery(pMapping, &info, sizeof(info));
+
+            return Join(pMapping, static_cast<uint64_t>(info.RegionSize), layout, creating);
+        }
+#else
+        [[nodiscard]] static auto Open(const char *name, const Layout& layout) -> Mapping
+        {
+            // Only the exclusive open creates, everyone else attaches however early they get here
+            int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            const bool creating = fd >= 0;
+
+            if (fd < 0)
+                fd = shm_open(name, O_RDWR, 0600);
+
+            if (fd < 0)
+                throw std::runtime_error("Could not open shared memory segment...");
+
+            try
+            {
+                Mapping mapping = Attach(fd, layout, creating);
+                close(fd);
+                return mapping;
+            }
+            catch (...)
+            {
+                close(fd);
+                throw;
+            }
+        }
+
+        // A plain fd has no exclusive open to decide who creates. A POSIX record lock (not
+        //  flock, forked children share that) keeps the check, the sizing and the header
+        //  write of one process away from every other
+        [[nodiscard]] static auto Adopt(int fd, const Layout& layout) -> Mapping
+        {
+            struct flock region{};
+            region.l_type   = F_WRLCK;
+            region.l_whence = SEEK_SET;
+
+            if (fcntl(fd, F_SETLKW, &region) != 0)
+                throw std::runtime_error("Could not lock shared memory segment...");
+
+            struct stat info{};
+            const bool creating = fstat(fd, &info) == 0 && info.st_size == 0;
+
+            region.l_type = F_UNLCK;
+
+            try
+            {
+                Mapping mapping = Attach(fd, layout, creating);
+                fcntl(fd, F_SETLK, &region);
+                return mapping;
+            }
+            catch (...)
+            {
+                fcntl(fd, F_SETLK, &region);
+                throw;
+            }
+        }
+
+        // The creator sizes the segment, attachers wait for that and Join() then waits for the header
+        [[nodiscard]] static auto Attach(int fd, const Layout& layout, bool creating) -> Mapping
+        {
+            if (creating && ftruncate(fd, static_cast<off_t>(layout.totalBytes)) != 0)
+                throw std::runtime_error("Could not size shared memory segment...");
+
+            struct stat info{};
+
+            while (fstat(fd, &info) == 0 && info.st_size == 0)
+                std::this_thread::yield();
+
+            const uint64_t bytes = static_cast<uint64_t>(info.st_size);
+            void *pMapping = bytes != 0U ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+            if (pMapping == MAP_FAILED)
+                throw std::runtime_error("Could not map shared memory segment...");
+
+            return Join(pMapping, bytes, layout, creating);
+        }
+#endif
+    };
+
+    ////////////////////////////////////////////////
+    // Callbacks
+    using OnReallocateCallback = std::function<void()>;
+
+    ////////////////////////////////////////////////
+    // RelocationMap
+    //  Old to new element offsets produced by FixedTypeAllocator::Compact(). Offsets that
+    //  didn't move aren't stored
+    class RelocationMap
+    {
+    public:
+        struct Relocation
+        {
+            uint64_t from;
+            uint64_t to;
+        };
+
+        RelocationMap() = default;
+
+        explicit RelocationMap(std::vector<Relocation>&& relocations)
+            : m_Relocations(std::move(relocations))
+        {
+            std::sort(m_Relocations.begin(), m_Relocations.end(), [](const Relocation &a, const Relocation &b) { return a.from < b.from; });
+        }
+
+        [[nodiscard]] auto Find(uint64_t from) const noexcept -> uint64_t
+        {
+            auto it = std::lower_bound(m_Relocations.begin(), m_Relocations.end(), from, [](const Relocation &r, uint64_t value) { return r.from < value; });
+            return (it != m_Relocations.end() && it->from == from) ? it->to : from;
+        }
+
+        template<typename Type>
+        void Apply(OffsetPtr<Type>& ptr) const noexcept
+        {
+            if (ptr.Container())
+                ptr = OffsetPtr<Type>(ptr.Container(), Find(ptr.Internal()));
+        }
+
+        // Patches handles in bulk, [first, last) of OffsetPtr
+        template<typename It>
+        void Apply(It first, It last) const noexcept
+        {
+            for (; first != last; ++first)
+                Apply(*first);
+        }
+
+        [[nodiscard]] auto Relocations() const noexcept -> const std::vector<Relocation>& { return m_Relocations; }
+        [[nodiscard]] auto Empty() const noexcept -> bool { return m_Relocations.empty(); }
+
+    private:
+        std::vector<Relocation> m_Relocations{};
+    };
+
+    ////////////////////////////////////////////////
+    // Executors
+    //  Anything with Dispatch(count, task) that runs task(i) for every i in [0, count)
+    //  and returns once all of them are done, see FixedTypeAllocator::ForAllParallel()
+
+    // Persistent workers, the calling thread joins in. Tasks are split evenly into one slice
+    //  per thread, a thread that runs out of its own slice steals from the others
+    class ThreadPoolExecutor
+    {
+    public:
+        explicit ThreadPoolExecutor(uint32_t threadCount = std::max(1U, std::thread::hardware_concurrency()))
+            : m_Slices(std::max(1U, threadCount))
+        {
+            for (uint32_t i = 1; i < m_Slices.size(); ++i)
+                m_Workers.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+
+        ~ThreadPoolExecutor()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_Mutex);
+                m_Quit = true;
+            }
+
+            m_Wake.notify_all();
+
+            for (auto &worker : m_Workers)
+                worker.join();
+        }
+
+        ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+        ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+        [[nodiscard]] auto ThreadCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Slices.size()); }
+
+        // Process wide default, sized to the hardware
+        [[nodiscard]] static auto Shared() -> ThreadPoolExecutor&
+        {
+            static ThreadPoolExecutor executor{};
+            return executor;
+        }
+
+        // One dispatch at a time, a task must not dispatch on the same executor
+        template<typename Task>
+        void Dispatch(uint64_t count, Task&& task)
+        {
+            if (count == 0U)
+                return;
+
+            std::lock_guard<std::mutex> dispatchGuard(m_DispatchMutex);
+
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+
+                // Stragglers of the previous dispatch may still be scanning the slices
+                m_Done.wait(lock, [this]() { return m_Busy == 0U; });
+
+                const uint64_t slices = m_Slices.size();
+
+                for (uint64_t i = 0; i < slices; ++i)
+                {
+                    m_Slices[i].next.store(count * i / slices, std::memory_order_relaxed);
+                    m_Slices[i].end = count * (i + 1U) / slices;
+                }
+
+                m_Remaining.store(count, std::memory_order_relaxed);
+                m_pTask     = &task;
+                m_pInvoke   = [](void *pTask, uint64_t i) { (*static_cast<std::remove_reference_t<Task>*>(pTask))(i); };
+                m_Generation++;
+                m_Busy++;
+            }
+
+            m_Wake.notify_all();
+            RunSlices(0U);
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Busy--;
+            m_Done.wait(lock, [this]() { return m_Remaining.load(std::memory_order_acquire) == 0U; });
+        }
+
+    private:
+        struct alignas(64) Slice
+        {
+            std::atomic<uint64_t> next{ 0U };
+            uint64_t end = 0U;
+        };
+
+        void WorkerLoop(uint32_t self)
+        {
+            uint64_t seen = 0U;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_Wake.wait(lock, [&]() { return m_Quit || m_Generation != seen; });
+
+                    if (m_Quit)
+                        return;
+
+                    seen = m_Generation;
+                    m_Busy++;
+                }
+
+                RunSlices(self);
+
+                {
+                    std::lock_guard<std::mutex> guard(m_Mutex);
+                    m_Busy--;
+                }
+
+                m_Done.notify_all();
+            }
+        }
+
+        // Own slice first, then every other one in turn
+        void RunSlices(uint32_t self)
+        {
+            const uint64_t slices = m_Slices.size();
+
+            for (uint64_t k = 0; k < slices; ++k)
+            {
+                Slice &slice = m_Slices[(self + k) % slices];
+
+                for (;;)
+                {
+                    const uint64_t i = slice.next.fetch_add(1U, std::memory_order_relaxed);
+
+                    if (i >= slice.end)
+                        break;
+
+                    m_pInvoke(m_pTask, i);
+
+                    if (m_Remaining.fetch_sub(1U, std::memory_order_acq_rel) == 1U)
+                    {
+                        std::lock_guard<std::mutex> guard(m_Mutex);
+                        m_Done.notify_all();
+                    }
+                }
+            }
+        }
+
+        std::vector<Slice> m_Slices;
+        std::vector<std::thread> m_Workers{};
+
+        std::mutex m_DispatchMutex;
+        std::mutex m_Mutex;
+        std::condition_variable m_Wake;
+        std::condition_variable m_Done;
+
+        void *m_pTask = nullptr;
+        void (*m_pInvoke)(void*, uint64_t) = nullptr;
+        std::atomic<uint64_t> m_Remaining{ 0U };
+        uint64_t m_Generation   = 0U;
+        uint64_t m_Busy         = 0U;
+        bool m_Quit             = false;
+    };
+
+#if defined(ALC_STD_EXECUTION)
+    // Leaves scheduling to the standard library's parallel algorithms
+    struct StdParallelExecutor
+    {
+        template<typename Task>
+        void Dispatch(uint64_t count, Task&& task)
+        {
+            std::vector<uint64_t> indices(count);
+            std::iota(indices.begin(), indices.end(), 0U);
+            std::for_each(std::execution::par, indices.begin(), indices.end(), [&task](uint64_t i) { task(i); });
+        }
+    };
+#endif
+
+    ////////////////////////////////////////////////
+    // CacheAligned
+    //  Pads every slot to a whole cache line, for pools whose objects are written by
+    //  different threads. Still a Type, FixedTypeAllocator<CacheAligned<Particle>> hands
+    //  out OffsetPtrs that read like Particle ones
+    template<typename Type>
+    struct alignas(AlignedAllocator::CacheLineSize) CacheAligned
+        : public Type
+    {
+        using Type::Type;
+    };
+
+    ////////////////////////////////////////////////
+    // EpochDomain
+    //  Process wide epoch based reclamation. Readers pin the current epoch with a Guard while
+    //  they hold pointers into a pool, writers stamp what they retire with Stamp() and may
+    //  only reuse it once SafeEpoch() has moved past the stamp. Guards nest, one record per
+    //  thread is reused after the thread exits and never freed
+    class EpochDomain
+    {
+    public:
+        struct Guard
+        {
+            Guard() noexcept { EpochDomain::Enter(); }
+            ~Guard() { EpochDomain::Leave(); }
+
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+        };
+
+        static void Enter() noexcept
+        {
+            ThreadRecord &local = Local();
+
+            // seq_cst so the pin is visible before any pool word this reader loads next
+            if (local.depth++ == 0U)
+                local.pRecord->epoch.store(s_Epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+
+        static void Leave() noexcept
+        {
+            ThreadRecord &local = Local();
+
+            if (--local.depth == 0U)
+                local.pRecord->epoch.store(0U, std::memory_order_release);
+        }
+
+        // Call after the object is unreachable for new readers, returns its stamp
+        [[nodiscard]] static auto Stamp() noexcept -> uint64_t
+        {
+            return s_Epoch.fetch_add(1U, std::memory_order_seq_cst);
+        }
+
+        // Anything stamped below this is no longer seen by any reader
+        [[nodiscard]] static auto SafeEpoch() noexcept -> uint64_t
+        {
+            uint64_t safe = s_Epoch.load(std::memory_order_seq_cst);
+
+            for (Record *pRecord = s_pRecords.load(std::memory_order_acquire); pRecord; pRecord = pRecord->pNext)
+            {
+                const uint64_t epoch = pRecord->epoch.load(std::memory_order_seq_cst);
+
+                if (epoch != 0U && epoch < safe)
+                    safe = epoch;
+            }
+
+            return safe;
+        }
+
+    private:
+        struct alignas(AlignedAllocator::CacheLineSize) Record
+        {
+            std::atomic<uint64_t> epoch{ 0U };
+            std::atomic<bool> inUse{ true };
+            Record *pNext = nullptr;
+        };
+
+        struct ThreadRecord
+        {
+            ~ThreadRecord()
+            {
+                if (pRecord)
+                {
+                    pRecord->epoch.store(0U, std::memory_order_relaxed);
+                    pRecord->inUse.store(false, std::memory_order_release);
+                }
+            }
+
+            Record *pRecord = nullptr;
+            uint64_t depth  = 0U;
+        };
+
+        [[nodiscard]] static auto Local() noexcept -> ThreadRecord&
+        {
+            thread_local ThreadRecord local{};
+
+            if (!local.pRecord)
+                local.pRecord = AcquireRecord();
+
+            return local;
+        }
+
+        // Reuses a record left by an exited thread before adding one
+        [[nodiscard]] static auto AcquireRecord() -> Record*
+        {
+            for (Record *pRecord = s_pRecords.load(std::memory_order_acquire); pRecord; pRecord = pRecord->pNext)
+            {
+                bool free = false;
+
+                if (!pRecord->inUse.load(std::memory_order_relaxed) && pRecord->inUse.compare_exchange_strong(free, true, std::memory_order_acquire))
+                    return pRecord;
+            }
+
+            auto pRecord = new Record();
+            pRecord->pNext = s_pRecords.load(std::memory_order_relaxed);
+
+            while (!s_pRecords.compare_exchange_weak(pRecord->pNext, pRecord, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+
+            return pRecord;
+        }
+
+        static inline std::atomic<uint64_t> s_Epoch{ 1U };
+        static inline std::atomic<Record*> s_pRecords{ nullptr };
+    };
+
+    ////////////////////////////////////////////////
+    // Policies
+    //  Named building blocks for AllocatorPolicy, the one configuration object taken by
+    //  FixedTypeAllocator, BasicGeneralPurposeAllocator and BasicFsa. Everything resolves at
+    //  compile time, the hot paths keep their if constexpr branches
+    namespace Policies
+    {
+        template<bool Enabled>
+        struct Growth
+        {
+            static constexpr bool Reallocates = Enabled;
+        };
+
+        using Fixed         = Growth<false>;
+        using Reallocating  = Growth<true>;
+
+        template<bool Safe, bool Free>
+        struct Threading
+        {
+            static constexpr bool ThreadSafe    = Safe || Free;
+            static constexpr bool LockFree      = Free;
+        };
+
+        using SingleThreaded    = Threading<false, false>;
+        using Locked            = Threading<true, false>;
+        using LockFree          = Threading<true, true>;
+
+        template<bool Enabled>
+        struct Counting
+        {
+            static constexpr bool Stats = Enabled;
+        };
+
+        using NoStats       = Counting<false>;
+        using WithStats     = Counting<true>;
+        using DefaultStats  = Counting<CollectStats>;
+
+        // How free slots are found and live ones tracked, the LUT scan is always there
+        template<bool UseFreeList, bool UseSummary, bool UseDense>
+        struct Slots
+        {
+            static constexpr bool FreeList      = UseFreeList;
+            static constexpr bool Hierarchical  = UseSummary;
+            static constexpr bool Dense         = UseDense;
+        };
+
+        using Scan          = Slots<false, false, false>;
+        using FreeList      = Slots<true, false, false>;
+        using Hierarchical  = Slots<false, true, false>;
+        using Dense         = Slots<false, false, true>;
+
+        // When a popped slot is destroyed, Deferred waits for lock free readers
+        template<bool Enabled>
+        struct Reclamation
+        {
+            static constexpr bool Deferred = Enabled;
+        };
+
+        using Immediate = Reclamation<false>;
+        using Deferred  = Reclamation<true>;
+    }
+
+    // Memory is the backing itself, Pool, SegmentedPool, VirtualPool... The With* aliases swap
+    //  one block and keep the rest, AllocatorPolicy<>::WithThreading<Policies::LockFree>
+    template<
+            typename Growth         = Policies::Reallocating,
+            typename Threading      = Policies::SingleThreaded,
+            typename Memory         = Pool,
+            typename Counting       = Policies::DefaultStats,
+            typename SlotSearch     = Policies::Scan,
+            typename Reclamation    = Policies::Immediate>
+    struct AllocatorPolicy
+    {
+        static constexpr bool Reallocates   = Growth::Reallocates;
+        static constexpr bool ThreadSafe    = Threading::ThreadSafe;
+        static constexpr bool LockFree      = Threading::LockFree;
+        static constexpr bool Stats         = Counting::Stats;
+        static constexpr bool FreeList      = SlotSearch::FreeList;
+        static constexpr bool Hierarchical  = SlotSearch::Hierarchical;
+        static constexpr bool Dense         = SlotSearch::Dense;
+        static constexpr bool Deferred      = Reclamation::Deferred;
+
+        using Backing = Memory;
+
+        template<typename Other>
+        using WithGrowth = AllocatorPolicy<Other, Threading, Memory, Counting, SlotSearch, Reclamation>;
+
+        template<typename Other>
+        using WithThreading = AllocatorPolicy<Growth, Other, Memory, Counting, SlotSearch, Reclamation>;
+
+        template<typename Other>
+        using WithMemory = AllocatorPolicy<Growth, Threading, Other, Counting, SlotSearch, Reclamation>;
+
+        template<typename Other>
+        using WithCounting = AllocatorPolicy<Growth, Threading, Memory, Other, SlotSearch, Reclamation>;
+
+        template<typename Other>
+        using WithSlots = AllocatorPolicy<Growth, Threading, Memory, Counting, Other, Reclamation>;
+
+        template<typename Other>
+        using WithReclamation = AllocatorPolicy<Growth, Threading, Memory, Counting, SlotSearch, Other>;
+    };
+
+    ////////////////////////////////////////////////
+    // Buffer
+    //  Growable array for allocator bookkeeping. Unlike std::vector before C++20 it is
+    //  constexpr constructible, so an allocator holding a few can be constant initialized.
+    //  Spells the std::vector calls the allocators make, nothing else
+    template<typename Type>
+    class Buffer
+    {
+        static_assert(std::is_nothrow_move_constructible_v<Type>, "Growth moves elements and can't be undone half way");
+
+    public:
+        constexpr Buffer() noexcept = default;
+
+        ~Buffer()
+        {
+            clear();
+            ::operator delete(m_pData);
+        }
+
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        [[nodiscard]] auto size() const noexcept -> uint64_t { return m_Size; }
+        [[nodiscard]] auto data() noexcept -> Type* { return m_pData; }
+        [[nodiscard]] auto begin() noexcept -> Type* { return m_pData; }
+        [[nodiscard]] auto end() noexcept -> Type* { return m_pData + m_Size; }
+        [[nodiscard]] auto begin() const noexcept -> const Type* { return m_pData; }
+        [[nodiscard]] auto end() const noexcept -> const Type* { return m_pData + m_Size; }
+        [[nodiscard]] auto back() noexcept -> Type& { return m_pData[m_Size - 1U]; }
+        [[nodiscard]] auto operator[](uint64_t i) noexcept -> Type& { return m_pData[i]; }
+        [[nodiscard]] auto operator[](uint64_t i) const noexcept -> const Type& { return m_pData[i]; }
+
+        // The new element is built before the old ones move, args may point into the buffer
+        template<typename ...Args>
+        auto emplace_back(Args&& ...args) -> Type&
+        {
+            if (m_Size < m_Capacity)
+                return *new (m_pData + m_Size++)Type(std::forward<Args>(args)...);
+
+            const uint64_t capacity = std::max<uint64_t>(m_Capacity * 2U, 4U);
+            Type *pData = static_cast<Type*>(::operator new(capacity * sizeof(Type)));
+
+            try
+            {
+                new (pData + m_Size)Type(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                ::operator delete(pData);
+                throw;
+            }
+
+            Adopt(pData, capacity);
+            return m_pData[m_Size++];
+        }
+
+        void push_back(const Type& value) { emplace_back(value); }
+        void push_back(Type&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() noexcept { m_pData[--m_Size].~Type(); }
+
+        void clear() noexcept
+        {
+            while (m_Size != 0U)
+                pop_back();
+        }
+
+        void resize(uint64_t count, const Type& value)
+        {
+            while (m_Size > count)
+                pop_back();
+
+            Reserve(count);
+
+            while (m_Size < count)
+                new (m_pData + m_Size++)Type(value);
+        }
+
+        void assign(uint64_t count, const Type& value)
+        {
+            clear();
+            resize(count, value);
+        }
+
+        // [first, last) must lie in the buffer, the tail moves down over it
+        void erase(Type *pFirst, Type *pLast)
+        {
+            Type *pEnd = std::move(pLast, end(), pFirst);
+
+            while (end() != pEnd)
+                pop_back();
+        }
+
+    private:
+        void Reserve(uint64_t capacity)
+        {
+            if (capacity > m_Capacity)
+                Adopt(static_cast<Type*>(::operator new(capacity * sizeof(Type))), capacity);
+        }
+
+        // Moves the live elements over to pData and frees the old block
+        void Adopt(Type *pData, uint64_t capacity) noexcept
+        {
+            for (uint64_t i = 0; i < m_Size; ++i)
+            {
+                new (pData + i)Type(std::move(m_pData[i]));
+                m_pData[i].~Type();
+            }
+
+            ::operator delete(m_pData);
+            m_pData     = pData;
+            m_Capacity  = capacity;
+        }
+
+        Type *m_pData       = nullptr;
+        uint64_t m_Size     = 0U;
+        uint64_t m_Capacity = 0U;
+    };
+
+    ////////////////////////////////////////////////
+    // FixedTypeAllocator
+    template <
+            typename Type,
+            uint64_t Size       = 1024U,
+            typename Policy     = AllocatorPolicy<>,
+            std::enable_if_t<(Size > 0), int> = 0>
+    class FixedTypeAllocator
+        : public Allocator
+    {
+    public:
+        // Policy spelled out for the code below and for layers on top
+        static constexpr bool Reallocates   = Policy::Reallocates;
+        static constexpr bool ThreadSafe    = Policy::ThreadSafe;
+        static constexpr bool LockFree      = Policy::LockFree;
+        static constexpr bool FreeList      = Policy::FreeList;
+        static constexpr bool Hierarchical  = Policy::Hierarchical;
+        static constexpr bool Dense         = Policy::Dense;
+        static constexpr bool Deferred      = Policy::Deferred;
+        static constexpr bool Counted       = Policy::Stats;
+
+        using Backing = typename Policy::Backing;
+
+    private:
+        static_assert(!FreeList || sizeof(Type) >= sizeof(uint64_t), "FreeList needs slots large enough to hold a uint64_t link");
+        static_assert(!LockFree || (!FreeList && !Hierarchical), "LockFree claims slots straight from the LUT, FreeList and Hierarchical are not supported with it");
+        static_assert(!LockFree || std::atomic<uint64_t>::is_always_lock_free, "LockFree needs lock free 64 bit atomics");
+        static_assert(!LockFree || !Dense, "Dense swap removes can't be done with a CAS on the LUT, use a locked pool");
+        static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "LUT words are accessed in place as atomics");
+        static_assert(alignof(Type) <= AlignedAllocator::CacheLineSize, "Pool objects start on a cache line, no stricter alignment is available");
+        static_assert(!Backing::Persistent || std::is_trivially_copyable_v<Type>, "Mapped snapshots come back without running constructors");
+        static_assert(!Backing::Persistent || (!Reallocates && !FreeList), "Mapped snapshots can't grow and keep no free list links");
+        static_assert(!Backing::ProcessShared || LockFree, "Other processes only ever see the LUT, slots have to be claimed with a CAS");
+        static_assert(!Deferred || (LockFree && !Backing::ProcessShared), "Deferred reclamation lets lock free readers run next to Pop(), its epochs are per process");
+
+        // LockFree supersedes the mutex, it is only kept around to serialize growth
+        static constexpr bool Locked = ThreadSafe && !LockFree;
+
+        // A pool that can move under a concurrent Get() has to construct under the lock. Pop()
+        //  always destroys under it, the slot can be claimed again the moment it is released
+        static constexpr bool EarlyUnlock = Locked && (!Reallocates || Backing::StableAddresses);
+
+    public:
+        // Objects never move once constructed, layers that build objects outside the pool lock need this
+        static constexpr bool StableAddresses = !Reallocates || Backing::StableAddresses;
+
+        // Can be built Unallocated, a static one is then constant initialized. A lock free pool
+        //  only takes its first block behind the growth gate, so it has to be able to grow
+        static constexpr bool ConstantInitializable = std::is_same_v<Backing, Pool> && (!LockFree || Reallocates);
+
+        // Extra arguments go to the backing pool after element size and capacity,
+        //  e.g. the reservation size of a VirtualPool
+        template<typename ...BackingArgs>
+        explicit FixedTypeAllocator(BackingArgs&& ...backingArgs)
+            : m_Pool(sizeof(Type), Size, std::forward<BackingArgs>(backingArgs)...)
+        {
+            // Generations are tracked from the start, other processes may already hold handles
+            if constexpr (Backing::ProcessShared)
+            {
+                m_pGenerations.store(m_Pool.Generations(), std::memory_order_relaxed);
+                m_GenerationCount = m_Pool.capacity;
+                (void)HandleId();
+            }
+
+            if constexpr (Hierarchical)
+                RebuildSummary();
+
+            if constexpr (Dense)
+                RebuildDense();
+
+            if constexpr (Deferred)
+                m_LiveWords.assign(Bits::LutWords(m_Pool.capacity), 0U);
+        }
+
+        // Empty until the first Get(), which allocates Size slots like the constructor above would
+        constexpr explicit FixedTypeAllocator(Unallocated) noexcept
+            : m_Pool(sizeof(Type), Unallocated{})
+        {
+            static_assert(ConstantInitializable, "Only a Pool backing can start unallocated, lock free ones have to grow into it");
+        }
+
+        ~FixedTypeAllocator()
+        {
+            // Nobody can be reading any more, popped objects still owe their destructor
+            if constexpr (Deferred)
+            {
+                for (const RetiredSlot &retired : m_RetiredSlots)
+                    Slot(retired.index)->~Type();
+            }
+
+            ReclaimRetired();
+
+            if (m_HandleId.load(std::memory_order_relaxed) != HandleTable::InvalidPool)
+                HandleTable::Release(m_HandleId.load(std::memory_order_relaxed));
+
+            if constexpr (!Backing::ProcessShared)
+                delete[] m_pGenerations.load(std::memory_order_relaxed);
+        }
+
+        // Takes the first block of an Unallocated pool now instead of on the first Get()
+        void Allocate()
+        {
+            if constexpr (ConstantInitializable && LockFree)
+                GrowLockFree(0U);
+            else if constexpr (ConstantInitializable)
+            {
+                auto lock = Lock();
+
+                if (m_Pool.capacity == 0U)
+                    (void)Expand(0U);
+            }
+        }
+
+        void SetOnReallocateCallback(const OnReallocateCallback& cb) { m_pOnReallocateCallback = std::make_unique<OnReallocateCallback>(cb); }
+
+        [[nodiscard]] constexpr auto Internal() noexcept -> Backing * { return &m_Pool; }
+
+        // Unchecked slot address, for layers that construct into reserved slots
+        [[nodiscard]] auto Slot(uint64_t index) noexcept -> Type* { return m_Pool.template At<Type>(index); }
+
+        // Constructs Type(args...) in place, no arguments value initializes like before
+        template<typename ...Args>
+        [[nodiscard]] auto Get(Args&& ...args) -> OffsetPtr<Type>
+        {
+            return Emplace([&](Type *pFreeObject) { new (pFreeObject)Type(std::forward<Args>(args)...); });
+        }
+
+        // Default initialized, a trivial Type is left with whatever the slot held
+        [[nodiscard]] auto GetUninitialized() -> OffsetPtr<Type>
+        {
+            return Emplace([](Type *pFreeObject) { new (pFreeObject)Type; });
+        }
+
+        // Claims one slot and runs construct on it, shared by every Get flavour. Layers that
+        //  build something other than Type in the slot call it directly, construct runs
+        //  under the lock unless addresses are stable (inside the gate when lock free)
+        template<typename Construct>
+        [[nodiscard]] auto Emplace(Construct&& construct) -> OffsetPtr<Type>
+        {
+            if constexpr (LockFree)
+                return GetLockFree(construct);
+
+            // In case we're in a thread safe pool, lock. Every early exit releases it
+            auto lock = Lock();
+
+            if (m_Pool.size + 1 > m_Pool.capacity && !Expand(0U))
+            {
+                m_Stats.OnFailed();
+                return OffsetPtr<Type>{};
+            }
+
+            uint64_t index = 0U;
+
+            // O(1) path, reuse the most recently freed slot or take a never used one
+            if constexpr (FreeList)
+                index = PopFreeList();
+            else
+                index = FindFreeSlot();
+
+            MarkActive(index);
+            m_Pool.size++;
+            m_Stats.OnAlloc();
+
+            // Once the lut and the pool size have been mutated,
+            //  In case we're in a thread safe pool, unlock
+            BuildScope building(this);
+
+            if constexpr(EarlyUnlock)
+                lock.unlock();
+
+            // Placement if to get an initialized object, a throwing constructor hands the slot back
+            try
+            {
+                construct(Slot(index));
+            }
+            catch (...)
+            {
+                Unclaim(&index, 1U);
+                throw;
+            }
+
+            OffsetPtr<Type> offsetPtr (&m_Pool, index);
+
+            return offsetPtr;
+        }
+
+        void Pop(OffsetPtr<Type>& element)
+        {
+            if constexpr (LockFree)
+            {
+                PopLockFree(element);
+                return;
+            }
+
+            // In case we're in a thread safe pool, lock
+            auto lock = Lock();
+            PopUnlocked(element);
+        }
+
+        // Pop() counterpart of Emplace(). The active check, destroy and the release share one
+        //  lock, so of two calls for the same slot only the first destroys. False if the slot
+        //  was not active
+        template<typename Destroy>
+        auto Dispose(uint64_t index, Destroy&& destroy) -> bool
+        {
+            static_assert(!LockFree, "A lock free release can't keep a second Dispose() out while destroy runs");
+
+            auto lock = Lock();
+
+            if (index >= m_Pool.capacity || !(Word(index / Bits::WordBits) & (1ULL << (index % Bits::WordBits))))
+                return false;
+
+            destroy(Slot(index));
+
+            MarkInactive(index);
+            BumpGeneration(index);
+            m_Pool.size--;
+            m_Stats.OnFree();
+
+            if constexpr (FreeList)
+                PushFreeList(index);
+
+            return true;
+        }
+
+        // Handle flavour of Get(), 8 bytes and no virtual call to resolve. The pool registers
+        //  with the HandleTable on first use and republishes its base whenever it moves
+        template<typename ...Args>
+        [[nodiscard]] auto GetHandle(Args&& ...args) -> Handle<Type>
+        {
+            auto element = Get(std::forward<Args>(args)...);
+
+            if (!element.Container())
+                return Handle<Type>{};
+
+            return ToHandle(element);
+        }
+
+        [[nodiscard]] auto ToHandle(OffsetPtr<Type>& element) -> Handle<Type>
+        {
+            static_assert(Backing::Contiguous, "Handles resolve as base + index, the backing pool must be one block");
+
+            if (element.Container() != &m_Pool || element.Internal() > UINT32_MAX)
+                throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+
+            const uint32_t id = HandleId();
+            const uint16_t generation = m_pGenerations.load(std::memory_order_acquire)[element.Internal()].load(std::memory_order_relaxed);
+
+            return Handle<Type>(id, static_cast<uint32_t>(element.Internal()), generation);
+        }
+
+        [[nodiscard]] auto ToOffsetPtr(const Handle<Type>& element) -> OffsetPtr<Type>
+        {
+            if (element.PoolId() != m_HandleId.load(std::memory_order_relaxed) || element.PoolId() == HandleTable::InvalidPool)
+                throw std::out_of_range("Handle does not belong to this pool...");
+
+            return OffsetPtr<Type>(&m_Pool, element.Internal());
+        }
+
+        // The generation is checked by whatever releases the slot, under the lock or as a CAS on
+        //  lock free pools. Checked first and popped after, a stale handle could free the
+        //  object that reused its slot in between
+        void Pop(Handle<Type>& element)
+        {
+            if (element.PoolId() != m_HandleId.load(std::memory_order_relaxed) || element.PoolId() == HandleTable::InvalidPool)
+                return;
+
+            auto offsetPtr = ToOffsetPtr(element);
+
+            if constexpr (LockFree)
+            {
+                if (!ClaimGeneration(element))
+                    return;
+
+                PopLockFree(offsetPtr);
+            }
+            else
+            {
+                auto lock = Lock();
+
+                if (!IsValidUnlocked(element))
+                    return;
+
+                PopUnlocked(offsetPtr);
+            }
+
+            if (!offsetPtr.Container())
+                element.ZeroOut();
+        }
+
+        // O(1) in every build, generations are tracked from the first handle on
+        [[nodiscard]] auto IsValid(const Handle<Type>& element) -> bool
+        {
+            if (element.PoolId() != m_HandleId.load(std::memory_order_relaxed) || element.PoolId() == HandleTable::InvalidPool)
+                return false;
+
+            GateScope gate(this);
+            auto lock = Lock();
+
+            return IsValidUnlocked(element);
+        }
+
+        // Marks up to count free slots as taken without constructing anything, for layers that
+        //  build objects themselves. One lock (or one gate pass) and at most one growth per call
+        [[nodiscard]] auto ReserveSlots(uint64_t *pIndices, uint64_t count) -> uint64_t
+        {
+            return ClaimBatch(pIndices, count, [](const uint64_t*, uint64_t) {});
+        }
+
+        // Batch flavour of Get(), value initializes up to count objects and writes their
+        //  OffsetPtrs to out. Same single lock and single growth as ReserveSlots, returns
+        //  how many were made (fewer only when the pool can't reallocate)
+        template<typename OutputIt>
+        [[nodiscard]] auto GetN(uint64_t count, OutputIt out) -> uint64_t
+        {
+            std::vector<uint64_t> indices(count);
+
+            // Published only once the whole run is built, a throw destroys what was built and
+            //  hands every claimed slot back before readers could see any of them. Lock free
+            //  batches may already have published earlier runs, those are popped again
+            uint64_t published = 0U;
+
+            const auto onClaimed = [this, &published](const uint64_t *pClaimed, uint64_t claimed)
+            {
+                uint64_t built = 0U;
+
+                try
+                {
+                    for (; built < claimed; ++built)
+                        new (Slot(pClaimed[built]))Type();
+                }
+                catch (...)
+                {
+                    for (uint64_t i = 0; i < built; ++i)
+                        Slot(pClaimed[i])->~Type();
+
+                    Unclaim(pClaimed, claimed);
+                    throw;
+                }
+
+                for (uint64_t i = 0; i < claimed; ++i)
+                    Publish(pClaimed[i]);
+
+                published += claimed;
+            };
+
+            uint64_t made = 0U;
+
+            try
+            {
+                made = ClaimBatch(indices.data(), count, onClaimed);
+            }
+            catch (...)
+            {
+                std::vector<OffsetPtr<Type>> built;
+
+                for (uint64_t i = 0; i < published; ++i)
+                    built.emplace_back(&m_Pool, indices[i]);
+
+                PopN(built.data(), published);
+                throw;
+            }
+
+            for (uint64_t i = 0; i < made; ++i)
+                *out++ = OffsetPtr<Type>(&m_Pool, indices[i]);
+
+            return made;
+        }
+
+        // Batch flavour of Pop(), one lock (or one gate pass) for the whole batch. Lock free
+        //  pools release each LUT word with a single fetch_and. Popped elements are zeroed out
+        void PopN(OffsetPtr<Type> *pElements, uint64_t count)
+        {
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                if (pElements[i].Container() != &m_Pool)
+                    throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+            }
+
+            if constexpr (LockFree)
+            {
+                PopNLockFree(pElements, count);
+                return;
+            }
+
+            auto lock = Lock();
+
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const uint64_t index = pElements[i].Internal();
+
+                if (index >= m_Pool.capacity)
+                    throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+
+                if (!(Word(index / Bits::WordBits) & (1ULL << (index % Bits::WordBits))))
+                    continue;
+
+                // Destroyed under the lock, the batch only pays for one acquire
+                Slot(index)->~Type();
+
+                MarkInactive(index);
+                BumpGeneration(index);
+                m_Pool.size--;
+                m_Stats.OnFree();
+
+                if constexpr (FreeList)
+                    PushFreeList(index);
+
+                pElements[i].ZeroOut();
+            }
+        }
+
+        // Anything with data() and size(), std::vector<OffsetPtr<Type>> and friends
+        template<typename Range>
+        void PopN(Range& elements)
+        {
+            PopN(std::data(elements), static_cast<uint64_t>(std::size(elements)));
+        }
+
+        // Hands back slots from ReserveSlots, whatever lived in them must already be destroyed
+        void ReleaseSlots(const uint64_t *pIndices, uint64_t count)
+        {
+            if constexpr (LockFree)
+            {
+                GateScope gate(this);
+
+                for (uint64_t i = 0; i < count; ++i)
+                    ReleaseSlot(pIndices[i]);
+
+                return;
+            }
+
+            auto lock = Lock();
+
+            for (uint64_t i = 0; i < count; ++i)
+                ReleaseSlot(pIndices[i]);
+        }
+
+        // Out of range indices read as inactive. Locked pools answer under the lock, a Get()
+        //  may be flipping a bit in the same word
+        [[nodiscard]] auto IsActive(uint64_t index) -> bool
+        {
+            GateScope gate(this);
+            auto lock = Lock();
+
+            if (index >= m_Pool.capacity)
+                return false;
+
+            return (VisibleWord(index / Bits::WordBits) >> (index % Bits::WordBits)) & 1U;
+        }
+
+        // Gives memory past the highest active slot back to the OS, for backings that
+        //  can decommit (VirtualPool). Free list links would live in the dropped slots
+        void Trim()
+        {
+            static_assert(!FreeList, "Trim() can't keep free list links that point past the new capacity");
+            static_assert(!LockFree || Reallocates, "Trim() on a lock free pool needs the growth gate");
+
+            ExclusiveScope exclusive(this);
+
+            m_Pool.Trim();
+            AfterResize();
+        }
+
+        // Moves every live object (move construction, never memcpy) into a dense prefix and
+        //  shrinks capacity back towards the initial Size. Returns where each moved object
+        //  went so OffsetPtr holders can be patched. Slots reserved through ReserveSlots
+        //  (magazines) must be handed back first, they would be moved as if they were alive
+        [[nodiscard]] auto Compact() -> RelocationMap
+        {
+            static_assert(std::is_move_constructible_v<Type>, "Compact() move constructs objects into their new slots");
+            static_assert(!LockFree || Reallocates, "Compact() on a lock free pool needs the growth gate");
+            static_assert(!Deferred, "Compact() would move objects readers may still hold, and slots still waiting to be reclaimed");
+
+            ExclusiveScope exclusive(this);
+
+            std::vector<RelocationMap::Relocation> relocations{};
+            const uint64_t live = m_Pool.size;
+            const uint64_t newCapacity = std::max(live, Size);
+
+            if constexpr (Backing::StableAddresses)
+            {
+                // Two fingers, the highest live object fills the lowest hole until they meet
+                uint64_t hole = 0U;
+                uint64_t last = m_Pool.capacity;
+
+                for (;;)
+                {
+                    while (hole < last && IsActiveUnlocked(hole))
+                        hole++;
+
+                    while (last > hole && !IsActiveUnlocked(last - 1U))
+                        last--;
+
+                    if (last <= hole + 1U)
+                        break;
+
+                    --last;
+                    new (Slot(hole))Type(std::move(*Slot(last)));
+                    Slot(last)->~Type();
+
+                    MarkInactive(last);
+                    MarkActive(hole);
+                    BumpGeneration(last);
+                    BumpGeneration(hole);
+                    relocations.push_back({ last, hole });
+                }
+
+                m_Pool.Shrink(newCapacity);
+            }
+            else
+            {
+                // Fill a fresh block in index order, then let it take over
+                Backing fresh(sizeof(Type), newCapacity, m_Pool.pageOptions);
+                uint64_t next = 0U;
+
+                for (uint64_t w = 0; w < Bits::LutWords(m_Pool.capacity); ++w)
+                {
+                    for (uint64_t word = Word(w); word != 0U; word &= word - 1U)
+                    {
+                        const uint64_t index = w * Bits::WordBits + Bits::CountTrailingZeros(word);
+
+                        new (fresh.template At<Type>(next))Type(std::move(*Slot(index)));
+                        Slot(index)->~Type();
+
+                        *fresh.LutWord(next / Bits::WordBits) |= (1ULL << (next % Bits::WordBits));
+
+                        if (index != next)
+                        {
+                            BumpGeneration(index);
+                            BumpGeneration(next);
+                            relocations.push_back({ index, next });
+                        }
+
+                        next++;
+                    }
+                }
+
+                fresh.size = next;
+                m_Pool.Swap(fresh);
+            }
+
+            // Everything past the prefix is free and untouched
+            if constexpr (FreeList)
+            {
+                m_FreeHead  = FreeListEnd;
+                m_HighWater = live;
+            }
+
+            AfterResize();
+            OnReallocated();
+
+            return RelocationMap(std::move(relocations));
+        }
+
+        // Writes the pool to path for a MappedPool backed allocator to map back in
+        void Save(const char *path)
+        {
+            static_assert(std::is_trivially_copyable_v<Type>, "Mapped snapshots come back without running constructors");
+
+            ExclusiveScope exclusive(this);
+            SaveSnapshot(path, m_Pool);
+        }
+
+        // Live counts come from the pool itself, the rest needs ALC_STATS or a counting policy
+        [[nodiscard]] auto Stats() -> AllocatorStats
+        {
+            GateScope gate(this);
+            auto lock = Lock();
+
+            AllocatorStats stats{};
+            m_Stats.Fill(stats);
+
+            if constexpr (LockFree)
+                stats.live = AtomicSize().load(std::memory_order_relaxed);
+            else
+                stats.live = m_Pool.size;
+
+            stats.peak          = std::max(stats.peak, stats.live);
+            stats.capacity      = m_Pool.capacity;
+            stats.fragmentation = AllocatorStats::Fragmentation(stats.live, Bits::ActiveSpan(Bits::LutWords(m_Pool.capacity), [this](uint64_t w) { return LoadWord(w); }));
+
+            return stats;
+        }
+
+        // Destroys and frees popped slots no reader can still see, Pop() calls this on its own
+        //  every CollectThreshold retires. Returns how many slots were reclaimed
+        auto Collect() -> uint64_t
+        {
+            static_assert(Deferred, "Only Deferred pools retire slots");
+
+            GateScope gate(this);
+            std::lock_guard<std::mutex> guard(m_RetireMutex);
+
+            const uint64_t safe = EpochDomain::SafeEpoch();
+            auto keep = m_RetiredSlots.begin();
+
+            for (const RetiredSlot &retired : m_RetiredSlots)
+            {
+                if (retired.stamp >= safe)
+                {
+                    *keep++ = retired;
+                    continue;
+                }
+
+                // Destroy before the bit is released, a claimer may construct right after
+                Slot(retired.index)->~Type();
+                AtomicWord(retired.index / Bits::WordBits).fetch_and(~(1ULL << (retired.index % Bits::WordBits)), std::memory_order_release);
+            }
+
+            const uint64_t reclaimed = static_cast<uint64_t>(m_RetiredSlots.end() - keep);
+            m_RetiredSlots.erase(keep, m_RetiredSlots.end());
+
+            return reclaimed;
+        }
+
+        // Frees pool blocks left behind by lock free growth. Only call this at a quiescent
+        //  point, when no thread still holds a Type* resolved before the last growth
+        void ReclaimRetired()
+        {
+            // Only a backing that moves on growth leaves an old block behind
+            if constexpr (!Backing::StableAddresses)
+            {
+                for (const RetiredBlock &retired : m_Retired)
+                    m_Pool.ReleaseBlock(retired.pBlock, retired.capacity);
+            }
+
+            m_Retired.clear();
+            m_RetiredGenerations.clear();
+        }
+
+    private:
+        // Shared by ReserveSlots and GetN. onClaimed(pIndices, n) runs on every claimed run while
+        //  the pool can't move under it, inside the lock (or the gate) unless addresses are stable
+        template<typename OnClaimed>
+        [[nodiscard]] auto ClaimBatch(uint64_t *pIndices, uint64_t count, OnClaimed&& onClaimed) -> uint64_t
+        {
+            if constexpr (LockFree)
+                return ClaimBatchLockFree(pIndices, count, onClaimed);
+
+            auto lock = Lock();
+
+            if (m_Pool.size + count > m_Pool.capacity)
+                (void)Expand(m_Pool.size + count);
+
+            const uint64_t wanted = std::min(count, m_Pool.capacity - m_Pool.size);
+            uint64_t reserved = 0U;
+
+            if constexpr (FreeList)
+            {
+                while (reserved < wanted)
+                {
+                    pIndices[reserved] = PopFreeList();
+                    MarkActive(pIndices[reserved++]);
+                }
+            }
+            else
+            {
+                const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+                uint64_t w = 0U;
+
+                // Take every free bit of a word before moving on to the next
+                for (; w < lutWords && reserved < wanted; ++w)
+                {
+                    uint64_t free = ~Word(w) & WordMask(w);
+
+                    while (free != 0U && reserved < wanted)
+                    {
+                        pIndices[reserved] = w * Bits::WordBits + Bits::CountTrailingZeros(free);
+                        MarkActive(pIndices[reserved++]);
+                        free &= free - 1U;
+                    }
+                }
+
+                m_Stats.OnScan(w);
+            }
+
+            m_Pool.size += reserved;
+            m_Stats.OnAlloc(reserved);
+
+            if (reserved < count)
+                m_Stats.OnFailed();
+
+            BuildScope building(this);
+
+            if constexpr (EarlyUnlock)
+                lock.unlock();
+
+            onClaimed(pIndices, reserved);
+
+            return reserved;
+        }
+
+        // Caller holds the lock (or the gate). Inactive slots are left alone
+        void ReleaseSlot(uint64_t index)
+        {
+            if constexpr (LockFree)
+            {
+                const uint64_t flag = (1ULL << (index % Bits::WordBits));
+                BumpGeneration(index);
+
+                if (AtomicWord(index / Bits::WordBits).fetch_and(~flag, std::memory_order_release) & flag)
+                {
+                    AtomicSize().fetch_sub(1U, std::memory_order_relaxed);
+                    m_Stats.OnFree();
+                }
+
+                return;
+            }
+
+            if (!(Word(index / Bits::WordBits) & (1ULL << (index % Bits::WordBits))))
+                return;
+
+            MarkInactive(index);
+            BumpGeneration(index);
+            m_Pool.size--;
+            m_Stats.OnFree();
+
+            if constexpr (FreeList)
+                PushFreeList(index);
+        }
+
+        // Rolls back slots whose constructor threw. Runs where the construct did, still under
+        //  the lock (or the gate) unless the pool unlocked early
+        void Unclaim(const uint64_t *pIndices, uint64_t count)
+        {
+            std::unique_lock<std::mutex> lock;
+
+            if constexpr (EarlyUnlock)
+                lock = Lock();
+
+            for (uint64_t i = 0; i < count; ++i)
+                ReleaseSlot(pIndices[i]);
+        }
+
+        // Full pool, caller holds the lock. An Unallocated pool takes its first block here, at
+        //  least Size, a Fixed one too. False when the pool can't grow
+        [[nodiscard]] auto Expand(uint64_t minCapacity) -> bool
+        {
+            if constexpr (ConstantInitializable)
+            {
+                if (m_Pool.capacity == 0U)
+                {
+                    m_Pool.Reallocate(Reallocates ? std::max(minCapacity, Size) : Size);
+                    AfterResize();
+                    return true;
+                }
+            }
+
+            if constexpr (Reallocates)
+            {
+                m_Pool.Reallocate(minCapacity);
+                AfterResize();
+                m_Stats.OnReallocate();
+                OnReallocated();
+                return true;
+            }
+            else
+                return false;
+        }
+
+        void OnReallocated()
+        {
+            if (m_pOnReallocateCallback)
+                (*m_pOnReallocateCallback)();
+        }
+
+        [[nodiscard]] auto Lock() -> std::unique_lock<std::mutex>
+        {
+            if constexpr (Locked)
+                return m_Stats.Lock(m_Mutex);
+            else
+                return std::unique_lock<std::mutex>();
+        }
+
+        [[nodiscard]] auto Word(uint64_t w) noexcept -> uint64_t&
+        {
+            return *m_Pool.LutWord(w);
+        }
+
+        [[nodiscard]] auto AtomicWord(uint64_t w) noexcept -> std::atomic<uint64_t>&
+        {
+            return *reinterpret_cast<std::atomic<uint64_t>*>(m_Pool.LutWord(w));
+        }
+
+        [[nodiscard]] auto AtomicSize() noexcept -> std::atomic<uint64_t>&
+        {
+            return reinterpret_cast<std::atomic<uint64_t>&>(m_Pool.size);
+        }
+
+        [[nodiscard]] auto LoadWord(uint64_t w) noexcept -> uint64_t
+        {
+            if constexpr (LockFree)
+                return AtomicWord(w).load(std::memory_order_acquire);
+            else
+                return Word(w);
+        }
+
+        // Deferred pools split the LUT in two. The LUT itself still says which slots are taken
+        //  and is all claims look at, live words say which objects readers may visit. A popped
+        //  slot leaves the live words at once and the LUT only when it is reclaimed
+        [[nodiscard]] auto LiveWord(uint64_t w) noexcept -> std::atomic<uint64_t>&
+        {
+            return reinterpret_cast<std::atomic<uint64_t>*>(m_LiveWords.data())[w];
+        }
+
+        [[nodiscard]] auto VisibleWord(uint64_t w) noexcept -> uint64_t
+        {
+            if constexpr (Deferred)
+                return LiveWord(w).load(std::memory_order_acquire);
+            else
+                return LoadWord(w);
+        }
+
+        // Makes a constructed object visible to readers
+        void Publish(uint64_t index) noexcept
+        {
+            if constexpr (Deferred)
+                LiveWord(index / Bits::WordBits).fetch_or(1ULL << (index % Bits::WordBits), std::memory_order_release);
+        }
+
+        // Pins the reader epoch for the duration of a traversal, nothing to do otherwise
+        struct ReadScope
+        {
+            ReadScope() noexcept
+            {
+                if constexpr (Deferred)
+                    EpochDomain::Enter();
+            }
+
+            ~ReadScope()
+            {
+                if constexpr (Deferred)
+                    EpochDomain::Leave();
+            }
+        };
+
+        // Growth gate for lock free pools that reallocate. In flight operations are counted
+        //  in the low bits, a growing thread raises GrowBit and waits for them to drain
+        static constexpr uint64_t GrowBit = 1ULL << 63U;
+
+        void EnterGate()
+        {
+            if constexpr (LockFree && Reallocates)
+            {
+                for (;;)
+                {
+                    if ((m_Gate.fetch_add(1U, std::memory_order_acquire) & GrowBit) == 0U)
+                        return;
+
+                    m_Gate.fetch_sub(1U, std::memory_order_relaxed);
+
+                    while (m_Gate.load(std::memory_order_relaxed) & GrowBit)
+                        std::this_thread::yield();
+                }
+            }
+        }
+
+        void LeaveGate()
+        {
+            if constexpr (LockFree && Reallocates)
+                m_Gate.fetch_sub(1U, std::memory_order_release);
+        }
+
+        struct GateScope
+        {
+            explicit GateScope(FixedTypeAllocator *pOwner) : pAllocator(pOwner) { pAllocator->EnterGate(); }
+            ~GateScope() { pAllocator->LeaveGate(); }
+
+            FixedTypeAllocator *pAllocator;
+        };
+
+        // Early unlock pools construct outside the lock. Taken under the lock before it is
+        //  released, so once a holder of the lock reads zero no object is half built
+        struct BuildScope
+        {
+            explicit BuildScope(FixedTypeAllocator *pOwner) : pAllocator(pOwner)
+            {
+                if constexpr (EarlyUnlock)
+                    pAllocator->m_Building.fetch_add(1U, std::memory_order_relaxed);
+            }
+
+            ~BuildScope()
+            {
+                if constexpr (EarlyUnlock)
+                    pAllocator->m_Building.fetch_sub(1U, std::memory_order_release);
+            }
+
+            FixedTypeAllocator *pAllocator;
+        };
+
+        // Sole access to the pool, takes the mutex and on lock free pools also closes the gate.
+        //  Early unlock pools also wait out every constructor still running, with the mutex
+        //  released in between since a throwing one relocks to hand its slot back
+        struct ExclusiveScope
+        {
+            explicit ExclusiveScope(FixedTypeAllocator *pOwner)
+                : pAllocator(pOwner)
+            {
+                if constexpr (ThreadSafe || LockFree)
+                    lock = std::unique_lock<std::mutex>(pAllocator->m_Mutex);
+
+                if constexpr (EarlyUnlock)
+                {
+                    while (pAllocator->m_Building.load(std::memory_order_acquire) != 0U)
+                    {
+                        lock.unlock();
+                        std::this_thread::yield();
+                        lock.lock();
+                    }
+                }
+
+                if constexpr (LockFree && Reallocates)
+                {
+                    pAllocator->m_Gate.fetch_or(GrowBit, std::memory_order_acq_rel);
+
+                    while ((pAllocator->m_Gate.load(std::memory_order_acquire) & ~GrowBit) != 0U)
+                        std::this_thread::yield();
+                }
+            }
+
+            ~ExclusiveScope()
+            {
+                if constexpr (LockFree && Reallocates)
+                    pAllocator->m_Gate.fetch_and(~GrowBit, std::memory_order_release);
+            }
+
+            FixedTypeAllocator *pAllocator;
+            std::unique_lock<std::mutex> lock;
+        };
+
+        // Anything derived from where the pool lives or how big it is gets refreshed here
+        void AfterResize()
+        {
+            if constexpr (Deferred)
+                m_LiveWords.resize(Bits::LutWords(m_Pool.capacity), 0U);
+
+            if constexpr (Hierarchical)
+                RebuildSummary();
+
+            if constexpr (Dense)
+                RebuildDense();
+
+            if (m_HandleId.load(std::memory_order_relaxed) != HandleTable::InvalidPool)
+            {
+                GrowGenerations();
+                HandleTable::Publish(m_HandleId.load(std::memory_order_relaxed), m_Pool.Internal(), m_pGenerations.load(std::memory_order_relaxed));
+            }
+        }
+
+        // Never shrinks, a slot dropped by Trim() / Compact() keeps counting if it comes back
+        void GrowGenerations()
+        {
+            if (m_GenerationCount >= m_Pool.capacity)
+                return;
+
+            auto pGenerations = new HandleTable::Generation[m_Pool.capacity];
+            auto pOld = m_pGenerations.load(std::memory_order_relaxed);
+
+            for (uint64_t i = 0; i < m_Pool.capacity; ++i)
+                pGenerations[i].store(i < m_GenerationCount ? pOld[i].load(std::memory_order_relaxed) : 0U, std::memory_order_relaxed);
+
+            m_pGenerations.store(pGenerations, std::memory_order_release);
+            m_GenerationCount = m_Pool.capacity;
+
+            // Handle checks on other threads may still be reading the old counters
+            if (pOld)
+                m_RetiredGenerations.emplace_back(pOld);
+        }
+
+        // Only tracked once a handle exists, the caller owns the slot until its bit is released
+        void BumpGeneration(uint64_t index) noexcept
+        {
+            if (auto pGenerations = m_pGenerations.load(std::memory_order_acquire))
+                pGenerations[index].fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        // Registration is serialized with growth through the mutex so the published base is current
+        [[nodiscard]] auto HandleId() -> uint32_t
+        {
+            uint32_t id = m_HandleId.load(std::memory_order_acquire);
+
+            if (id == HandleTable::InvalidPool)
+            {
+                std::lock_guard<std::mutex> guard(m_Mutex);
+                id = m_HandleId.load(std::memory_order_relaxed);
+
+                if (id == HandleTable::InvalidPool)
+                {
+                    GrowGenerations();
+
+                    if constexpr (Backing::ProcessShared)
+                        id = HandleTable::RegisterShared(m_Pool.SharedId(), m_Pool.Internal(), m_pGenerations.load(std::memory_order_relaxed));
+                    else
+                        id = HandleTable::Register(m_Pool.Internal(), m_pGenerations.load(std::memory_order_relaxed));
+
+                    m_HandleId.store(id, std::memory_order_release);
+                }
+            }
+
+            return id;
+        }
+
+        // Pop() with the lock already held
+        void PopUnlocked(OffsetPtr<Type>& element)
+        {
+            const uint64_t index = element.Internal();
+
+            if (element.Container() != &m_Pool || index >= m_Pool.capacity)
+                throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+
+            // If item active, disable it
+            if (Word(index / Bits::WordBits) & (1ULL << (index % Bits::WordBits)))
+            {
+                // Since we're not calling delete, ~Type() is called manually. Still under the
+                //  lock, once the bit flips another Get() may construct in the slot
+                Slot(index)->~Type();
+
+                // Flip bit
+                MarkInactive(index);
+                BumpGeneration(index);
+
+                // Decrease used size
+                m_Pool.size--;
+                m_Stats.OnFree();
+
+                // Thread the dead slot onto the free list, its memory holds the next index.
+                //  The head is shared state so this has to happen before unlocking
+                if constexpr (FreeList)
+                    PushFreeList(index);
+
+                element.ZeroOut();
+            }
+        }
+
+        [[nodiscard]] auto IsActiveUnlocked(uint64_t index) noexcept -> bool
+        {
+            return (Word(index / Bits::WordBits) >> (index % Bits::WordBits)) & 1U;
+        }
+
+        // Handle of a pool that already registered, inside the lock or the gate
+        [[nodiscard]] auto IsValidUnlocked(const Handle<Type>& element) noexcept -> bool
+        {
+            if (element.Internal() >= m_Pool.capacity || !(VisibleWord(element.Internal() / Bits::WordBits) >> (element.Internal() % Bits::WordBits) & 1U))
+                return false;
+
+            return m_pGenerations.load(std::memory_order_acquire)[element.Internal()].load(std::memory_order_relaxed) == element.Generation();
+        }
+
+        // Moving the generation on from the one the handle carries is what claims the pop,
+        //  of two handles racing for a slot only the current one can win
+        [[nodiscard]] auto ClaimGeneration(const Handle<Type>& element) -> bool
+        {
+            GateScope gate(this);
+
+            if (!IsValidUnlocked(element))
+                return false;
+
+            uint16_t expected = element.Generation();
+            return m_pGenerations.load(std::memory_order_acquire)[element.Internal()].compare_exchange_strong(expected, static_cast<uint16_t>(expected + 1U), std::memory_order_acq_rel);
+        }
+
+        // Claims clear bits with a CAS on their LUT word, as many per CAS as the word has and
+        //  the caller wants. Scans from the word that last succeeded so threads don't all
+        //  fight over word 0
+        [[nodiscard]] auto ClaimSlotsAtomic(uint64_t *pIndices, uint64_t count) -> uint64_t
+        {
+            const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+
+            // Still Unallocated, the caller grows
+            if (lutWords == 0U)
+                return 0U;
+
+            const uint64_t start    = m_ClaimHint.load(std::memory_order_relaxed) % lutWords;
+            uint64_t claimed = 0U;
+
+            uint64_t n = 0U;
+
+            for (; n < lutWords && claimed < count; ++n)
+            {
+                const uint64_t w    = (start + n) % lutWords;
+                const uint64_t mask = WordMask(w);
+                auto &atomicWord = AtomicWord(w);
+                uint64_t word = atomicWord.load(std::memory_order_relaxed);
+
+                while ((~word & mask) != 0U && claimed < count)
+                {
+                    // Lowest free bits, up to what is still needed
+                    uint64_t free = ~word & mask;
+                    uint64_t take = 0U;
+
+                    for (uint64_t k = claimed; k < count && free != 0U; ++k)
+                    {
+                        take |= free & (0U - free);
+                        free &= free - 1U;
+                    }
+
+                    // Acquire pairs with the release in PopLockFree, the previous ~Type() is done
+                    if (atomicWord.compare_exchange_weak(word, word | take, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        word |= take;
+
+                        while (take != 0U)
+                        {
+                            pIndices[claimed++] = w * Bits::WordBits + Bits::CountTrailingZeros(take);
+                            take &= take - 1U;
+                        }
+
+                        m_ClaimHint.store(w, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            AtomicSize().fetch_add(claimed, std::memory_order_relaxed);
+            m_Stats.OnScan(n);
+            m_Stats.OnAlloc(claimed);
+
+            return claimed;
+        }
+
+        template<typename OnClaimed>
+        [[nodiscard]] auto ClaimBatchLockFree(uint64_t *pIndices, uint64_t count, OnClaimed& onClaimed) -> uint64_t
+        {
+            uint64_t reserved = 0U;
+
+            for (;;)
+            {
+                uint64_t capacity = 0U;
+                uint64_t size     = 0U;
+
+                {
+                    GateScope gate(this);
+
+                    capacity = m_Pool.capacity;
+                    const uint64_t claimed = ClaimSlotsAtomic(pIndices + reserved, count - reserved);
+
+                    // Inside the gate for the same reason as GetLockFree
+                    onClaimed(pIndices + reserved, claimed);
+                    reserved += claimed;
+                    size = AtomicSize().load(std::memory_order_relaxed);
+                }
+
+                if (reserved == count)
+                    return reserved;
+
+                // Popped slots that are already safe beat growing
+                if constexpr (Deferred)
+                {
+                    if (Collect() != 0U)
+                        continue;
+                }
+
+                // Sized for the whole remainder so a batch grows once unless others race it
+                if constexpr (Reallocates)
+                    GrowLockFree(capacity, size + (count - reserved));
+                else
+                {
+                    m_Stats.OnFailed();
+                    return reserved;
+                }
+            }
+        }
+
+        template<typename Construct>
+        [[nodiscard]] auto GetLockFree(Construct& construct) -> OffsetPtr<Type>
+        {
+            for (;;)
+            {
+                uint64_t capacity = 0U;
+
+                {
+                    GateScope gate(this);
+
+                    capacity = m_Pool.capacity;
+                    uint64_t index = 0U;
+
+                    if (ClaimSlotsAtomic(&index, 1U) == 1U)
+                    {
+                        // Constructed inside the gate so growth never copies a half built object
+                        try
+                        {
+                            construct(Slot(index));
+                        }
+                        catch (...)
+                        {
+                            Unclaim(&index, 1U);
+                            throw;
+                        }
+
+                        Publish(index);
+
+                        return OffsetPtr<Type>(&m_Pool, index);
+                    }
+                }
+
+                if constexpr (Deferred)
+                {
+                    if (Collect() != 0U)
+                        continue;
+                }
+
+                if constexpr (Reallocates)
+                    GrowLockFree(capacity);
+                else
+                {
+                    m_Stats.OnFailed();
+                    return OffsetPtr<Type>{};
+                }
+            }
+        }
+
+        void PopNLockFree(OffsetPtr<Type> *pElements, uint64_t count)
+        {
+            if constexpr (Deferred)
+            {
+                RetireN(pElements, count);
+                return;
+            }
+
+            GateScope gate(this);
+
+            uint64_t pendingWord = UINT64_MAX;
+            uint64_t pendingMask = 0U;
+
+            const auto release = [&]()
+            {
+                if (pendingMask == 0U)
+                    return;
+
+                const uint64_t released = AtomicWord(pendingWord).fetch_and(~pendingMask, std::memory_order_release) & pendingMask;
+                AtomicSize().fetch_sub(Bits::PopCount(released), std::memory_order_relaxed);
+                m_Stats.OnFree(Bits::PopCount(released));
+                pendingMask = 0U;
+            };
+
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const uint64_t index = pElements[i].Internal();
+
+                if (index >= m_Pool.capacity)
+                {
+                    release();
+                    throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+                }
+
+                // Runs of elements in the same word go out together
+                if (index / Bits::WordBits != pendingWord)
+                {
+                    release();
+                    pendingWord = index / Bits::WordBits;
+                }
+
+                const uint64_t flag = (1ULL << (index % Bits::WordBits));
+
+                // A repeat inside the batch still reads as active until the word is released
+                if (!(AtomicWord(pendingWord).load(std::memory_order_relaxed) & flag) || (pendingMask & flag))
+                    continue;
+
+                Slot(index)->~Type();
+                BumpGeneration(index);
+
+                pendingMask |= flag;
+                pElements[i].ZeroOut();
+            }
+
+            release();
+        }
+
+        void PopLockFree(OffsetPtr<Type>& element)
+        {
+            if constexpr (Deferred)
+            {
+                RetireN(&element, 1U);
+                return;
+            }
+
+            GateScope gate(this);
+
+            const uint64_t index = element.Internal();
+
+            if (element.Container() != &m_Pool || index >= m_Pool.capacity)
+                throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+
+            auto &word      = AtomicWord(index / Bits::WordBits);
+            uint64_t flag   = (1ULL << (index % Bits::WordBits));
+
+            if (word.load(std::memory_order_relaxed) & flag)
+            {
+                // Destroy before the bit is released, a claimer may construct right after
+                Slot(index)->~Type();
+                BumpGeneration(index);
+                word.fetch_and(~flag, std::memory_order_release);
+
+                AtomicSize().fetch_sub(1U, std::memory_order_relaxed);
+                m_Stats.OnFree();
+                element.ZeroOut();
+            }
+        }
+
+        // Unpublishes the batch, every later reader misses it at once. Destruction and the LUT
+        //  release wait in m_RetiredSlots until the epoch has moved past the stamp
+        void RetireN(OffsetPtr<Type> *pElements, uint64_t count)
+        {
+            std::vector<uint64_t> indices{};
+            indices.reserve(count);
+
+            {
+                GateScope gate(this);
+
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    const uint64_t index = pElements[i].Internal();
+
+                    if (index >= m_Pool.capacity)
+                        throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+
+                    const uint64_t flag = (1ULL << (index % Bits::WordBits));
+
+                    // Whoever clears the live bit owns the retire, repeats and double pops see it clear
+                    if (!(LiveWord(index / Bits::WordBits).fetch_and(~flag, std::memory_order_seq_cst) & flag))
+                        continue;
+
+                    BumpGeneration(index);
+                    indices.push_back(index);
+                    pElements[i].ZeroOut();
+                }
+            }
+
+            if (indices.empty())
+                return;
+
+            AtomicSize().fetch_sub(indices.size(), std::memory_order_relaxed);
+            m_Stats.OnFree(indices.size());
+
+            const uint64_t stamp = EpochDomain::Stamp();
+            bool collect = false;
+
+            {
+                std::lock_guard<std::mutex> guard(m_RetireMutex);
+
+                for (const uint64_t index : indices)
+                    m_RetiredSlots.push_back({ index, stamp });
+
+                collect = m_RetiredSlots.size() >= CollectThreshold;
+            }
+
+            if (collect)
+                (void)Collect();
+        }
+
+        // Only one thread grows, the rest wait at the gate. The old block is retired instead of
+        //  freed so a Type* resolved before growth stays readable until ReclaimRetired()
+        void GrowLockFree(uint64_t observedCapacity, uint64_t minCapacity = 0U)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_Mutex);
+
+                // Someone else already grew while we were waiting
+                if (m_Pool.capacity != observedCapacity)
+                    return;
+
+                m_Gate.fetch_or(GrowBit, std::memory_order_acq_rel);
+
+                while ((m_Gate.load(std::memory_order_acquire) & ~GrowBit) != 0U)
+                    std::this_thread::yield();
+
+                if (void *pOldBlock = m_Pool.Grow(observedCapacity == 0U ? std::max(minCapacity, Size) : minCapacity))
+                    m_Retired.push_back({ pOldBlock, observedCapacity });
+
+                AfterResize();
+
+                if (observedCapacity != 0U)
+                    m_Stats.OnReallocate();
+
+                m_Gate.fetch_and(~GrowBit, std::memory_order_release);
+            }
+
+            if (observedCapacity != 0U)
+                OnReallocated();
+        }
+
+        [[nodiscard]] auto PopFreeList() -> uint64_t
+        {
+            if (m_FreeHead == FreeListEnd)
+                return m_HighWater++;
+
+            const uint64_t index = m_FreeHead;
+            std::memcpy(&m_FreeHead, static_cast<const void*>(Slot(index)), sizeof(uint64_t));
+            return index;
+        }
+
+        // The slot must be dead, its memory is reused to hold the next index
+        void PushFreeList(uint64_t index)
+        {
+            std::memcpy(static_cast<void*>(Slot(index)), &m_FreeHead, sizeof(uint64_t));
+            m_FreeHead = index;
+        }
+
+        // Look up first available slot in pool, a full word is skipped in one compare
+        [[nodiscard]] auto FindFreeSlot() -> uint64_t
+        {
+            const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+
+            // With the summary only words that still have room are visited
+            if constexpr (Hierarchical)
+            {
+                for (uint64_t s = 0; s < m_FullWords.size(); ++s)
+                {
+                    if (~m_FullWords[s] == 0U)
+                        continue;
+
+                    const uint64_t word = s * Bits::WordBits + Bits::CountTrailingZeros(~m_FullWords[s]);
+                    if (word >= lutWords)
+                        break;
+
+                    m_Stats.OnScan(s + 1U);
+                    return word * Bits::WordBits + Bits::CountTrailingZeros(~Word(word));
+                }
+            }
+            else
+            {
+                for (uint64_t i = 0; i < lutWords; ++i)
+                {
+                    if (~Word(i) == 0U)
+                        continue;
+
+                    // Lowest clear bit is the first inactive entity in this word,
+                    //  bits past capacity in a partial last word read as free
+                    const uint64_t index = i * Bits::WordBits + Bits::CountTrailingZeros(~Word(i));
+                    if (index >= m_Pool.capacity)
+                        break;
+
+                    m_Stats.OnScan(i + 1U);
+                    return index;
+                }
+            }
+
+            // At this point something failed in the allocation
+            throw std::bad_alloc();
+        }
+
+        // Bits of LUT word w that map to slots inside capacity
+        [[nodiscard]] auto WordMask(uint64_t w) const noexcept -> uint64_t
+        {
+            const uint64_t tail = m_Pool.capacity % Bits::WordBits;
+
+            if (tail != 0U && w == Bits::LutWords(m_Pool.capacity) - 1U)
+                return (1ULL << tail) - 1U;
+
+            return ~0ULL;
+        }
+
+        void MarkActive(uint64_t index)
+        {
+            const uint64_t w = index / Bits::WordBits;
+            uint64_t &word = Word(w);
+            word |= (1ULL << (index % Bits::WordBits));
+
+            if constexpr (Hierarchical)
+            {
+                m_ActiveWords[w / Bits::WordBits] |= (1ULL << (w % Bits::WordBits));
+
+                if (word == WordMask(w))
+                    m_FullWords[w / Bits::WordBits] |= (1ULL << (w % Bits::WordBits));
+            }
+
+            if constexpr (Dense)
+            {
+                m_DensePos[index] = m_Dense.size();
+                m_Dense.push_back(index);
+            }
+        }
+
+        void MarkInactive(uint64_t index)
+        {
+            const uint64_t w = index / Bits::WordBits;
+            uint64_t &word = Word(w);
+            word &= ~(1ULL << (index % Bits::WordBits));
+
+            if constexpr (Hierarchical)
+            {
+                m_FullWords[w / Bits::WordBits] &= ~(1ULL << (w % Bits::WordBits));
+
+                if (word == 0U)
+                    m_ActiveWords[w / Bits::WordBits] &= ~(1ULL << (w % Bits::WordBits));
+            }
+
+            // Swap remove, the last live index takes over the hole
+            if constexpr (Dense)
+            {
+                const uint64_t pos  = m_DensePos[index];
+                const uint64_t last = m_Dense.back();
+
+                m_Dense[pos]        = last;
+                m_DensePos[last]    = pos;
+                m_Dense.pop_back();
+            }
+        }
+
+        // Summary level, one bit per LUT word. Rebuilt whenever the pool grows
+        void RebuildSummary()
+        {
+            const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+
+            m_FullWords.assign(Bits::LutWords(lutWords), 0U);
+            m_ActiveWords.assign(Bits::LutWords(lutWords), 0U);
+
+            for (uint64_t w = 0; w < lutWords; ++w)
+            {
+                if (Word(w) == WordMask(w))
+                    m_FullWords[w / Bits::WordBits] |= (1ULL << (w % Bits::WordBits));
+
+                if (Word(w) != 0U)
+                    m_ActiveWords[w / Bits::WordBits] |= (1ULL << (w % Bits::WordBits));
+            }
+        }
+
+        // Dense level, live indices packed in no particular order. Rebuilt whenever the pool grows
+        void RebuildDense()
+        {
+            const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+
+            m_Dense.clear();
+            m_DensePos.assign(m_Pool.capacity, 0U);
+
+            for (uint64_t w = 0; w < lutWords; ++w)
+            {
+                for (uint64_t word = Word(w); word != 0U; word &= word - 1U)
+                {
+                    const uint64_t index = w * Bits::WordBits + Bits::CountTrailingZeros(word);
+
+                    m_DensePos[index] = m_Dense.size();
+                    m_Dense.push_back(index);
+                }
+            }
+        }
+
+        // One 64 slot block. The callable is a template parameter all the way down so it
+        //  inlines into these loops, the full block loop has no branches left to vectorize around
+        template<typename Func>
+        void VisitWord(uint64_t w, Func& f)
+        {
+            Type *pPoolItem = Slot(w * Bits::WordBits);
+            uint64_t word   = VisibleWord(w);
+
+            // Full word, no need to look at the bits
+            if (~word == 0U)
+            {
+                for (uint64_t j = 0; j < Bits::WordBits; ++j)
+                    f(pPoolItem + j);
+
+                return;
+            }
+
+            // Walk set bits only, clearing the lowest one each step
+            while (word != 0U)
+            {
+                f(pPoolItem + Bits::CountTrailingZeros(word));
+                word &= word - 1U;
+            }
+        }
+
+        template<typename Func>
+        void ForAllActive(Func& f)
+        {
+            auto lock = Lock();
+            ReadScope read{};
+            GateScope gate(this);
+
+            // Cost follows the live count, not the capacity
+            if constexpr (Dense)
+            {
+                for (const uint64_t index : m_Dense)
+                    f(Slot(index));
+            }
+            else if constexpr (Hierarchical)
+            {
+                // Jump straight to words holding at least one active entity
+                for (uint64_t s = 0; s < m_ActiveWords.size(); ++s)
+                {
+                    uint64_t summary = m_ActiveWords[s];
+
+                    while (summary != 0U)
+                    {
+                        VisitWord(s * Bits::WordBits + Bits::CountTrailingZeros(summary), f);
+                        summary &= summary - 1U;
+                    }
+                }
+            }
+            else
+            {
+                const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+
+                for (uint64_t i = 0; i < lutWords; ++i)
+                    VisitWord(i, f);
+            }
+        }
+
+        // Every slot, live or not. Slots never handed out hold whatever the fresh memory held
+        template<typename Func>
+        void ForAllFast(Func& f)
+        {
+            auto lock = Lock();
+            ReadScope read{};
+            GateScope gate(this);
+
+            // One run per contiguous block of the backing pool
+            const uint64_t run = m_Pool.ContiguousSlots();
+
+            for (uint64_t first = 0; first < m_Pool.capacity; first += run)
+            {
+                Type *pPoolItem = Slot(first);
+                const uint64_t count = std::min(run, m_Pool.capacity - first);
+
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    f(pPoolItem);
+                    ++pPoolItem;
+                }
+            }
+        }
+
+        // One cache line of LUT words per task, 512 slots
+        static constexpr uint64_t ParallelRangeWords = 64U / sizeof(uint64_t);
+
+        template<typename Func>
+        void VisitRange(uint64_t range, uint64_t lutWords, Func& f)
+        {
+            const uint64_t first = range * ParallelRangeWords;
+
+            // A range never straddles two summary words, skip it when none of its words are active
+            if constexpr (Hierarchical)
+            {
+                if (((m_ActiveWords[first / Bits::WordBits] >> (first % Bits::WordBits)) & ((1ULL << ParallelRangeWords) - 1U)) == 0U)
+                    return;
+            }
+
+            const uint64_t last = std::min(first + ParallelRangeWords, lutWords);
+
+            for (uint64_t w = first; w < last; ++w)
+                VisitWord(w, f);
+        }
+
+    public:
+        // Any callable taking a Type*, a std::function still works but keeps its indirect call
+        template <bool IgnoreInactive = true, typename Func>
+        void ForAll(Func&& f)
+        {
+            if constexpr(IgnoreInactive)
+                ForAllActive(f);
+            else
+                ForAllFast(f);
+        }
+
+        // Active slots only, split into LUT ranges run on the executor. The pool is held for the
+        //  whole call (lock and growth gate on the calling thread), so f may touch its own object
+        //  from any thread but must not Get() / Pop() on this pool
+        template <typename Func, typename Executor = ThreadPoolExecutor>
+        void ForAllParallel(Func&& f, Executor& executor = ThreadPoolExecutor::Shared())
+        {
+            auto lock = Lock();
+            ReadScope read{};
+            GateScope gate(this);
+
+            if constexpr (Dense)
+            {
+                // Same 512 entries per task, taken from the dense array
+                const uint64_t live     = m_Dense.size();
+                const uint64_t entries  = ParallelRangeWords * Bits::WordBits;
+
+                executor.Dispatch((live + entries - 1U) / entries, [this, &f, live, entries](uint64_t range) {
+                    const uint64_t last = std::min(live, (range + 1U) * entries);
+
+                    for (uint64_t i = range * entries; i < last; ++i)
+                        f(Slot(m_Dense[i]));
+                });
+            }
+            else
+            {
+                const uint64_t lutWords = Bits::LutWords(m_Pool.capacity);
+                const uint64_t ranges   = (lutWords + ParallelRangeWords - 1U) / ParallelRangeWords;
+
+                executor.Dispatch(ranges, [this, &f, lutWords](uint64_t range) { VisitRange(range, lutWords, f); });
+            }
+        }
+
+    private:
+        static constexpr uint64_t FreeListEnd = ~0ULL;
+
+        Backing m_Pool;
+        std::unique_ptr<OnReallocateCallback> m_pOnReallocateCallback{};
+
+        // Waiters spin on the mutex line, nothing the lock holder writes may share it
+        alignas(AlignedAllocator::CacheLineSize) std::mutex m_Mutex;
+
+        // Constructors running outside the lock on early unlock pools, see BuildScope
+        alignas(AlignedAllocator::CacheLineSize) std::atomic<uint64_t> m_Building{ 0U };
+
+        // Free list state, slots at or past the high water mark have never been handed out
+        alignas(AlignedAllocator::CacheLineSize) uint64_t m_FreeHead = FreeListEnd;
+        uint64_t m_HighWater    = 0U;
+
+        ALC_NO_UNIQUE_ADDRESS StatsCounters<Counted> m_Stats{};
+
+        // Hierarchical summary, bit w is set when LUT word w is full / has any active slot
+        Buffer<uint64_t> m_FullWords{};
+        Buffer<uint64_t> m_ActiveWords{};
+
+        // Dense mode, live slot indices and each slot's position among them
+        Buffer<uint64_t> m_Dense{};
+        Buffer<uint64_t> m_DensePos{};
+
+        // HandleTable registration and per slot generations, taken on first GetHandle()
+        std::atomic<uint32_t> m_HandleId{ HandleTable::InvalidPool };
+        std::atomic<HandleTable::Generation*> m_pGenerations{ nullptr };
+        uint64_t m_GenerationCount = 0U;
+        Buffer<std::unique_ptr<HandleTable::Generation[]>> m_RetiredGenerations{};
+
+        // Deferred reclamation, see LiveWord()
+        struct RetiredSlot
+        {
+            uint64_t index;
+            uint64_t stamp;
+        };
+
+        static constexpr uint64_t CollectThreshold = 64U;
+
+        // Pool blocks left behind by lock free growth, with the capacity they were sized for
+        struct RetiredBlock
+        {
+            void *pBlock;
+            uint64_t capacity;
+        };
+
+        Buffer<uint64_t> m_LiveWords{};
+        Buffer<RetiredSlot> m_RetiredSlots{};
+        std::mutex m_RetireMutex;
+
+        // Lock free state, every operation touches the gate and every claim the hint
+        alignas(AlignedAllocator::CacheLineSize) std::atomic<uint64_t> m_Gate{ 0U };
+        alignas(AlignedAllocator::CacheLineSize) std::atomic<uint64_t> m_ClaimHint{ 0U };
+        alignas(AlignedAllocator::CacheLineSize) Buffer<RetiredBlock> m_Retired{};
+    };
+
+    // The bool parameter list FixedTypeAllocator had before policies, the policy form keeps the
+    //  name since Type and Size lead both. FixedTypeAllocator<T, S, true, true> becomes
+    //  FlagFixedTypeAllocator<T, S, true, true>, LockFree on its own implies ThreadSafe as it did
+    template <
+            typename Type,
+            uint64_t Size       = 1024U,
+            bool Reallocates    = true,
+            bool ThreadSafe     = false,
+            bool FreeList       = false,
+            bool Hierarchical   = false,
+            bool LockFree       = false,
+            typename Backing    = Pool,
+            bool Dense          = false,
+            bool Deferred       = false>
+    using FlagFixedTypeAllocator = FixedTypeAllocator<Type, Size, AllocatorPolicy<
+            Policies::Growth<Reallocates>,
+            Policies::Threading<ThreadSafe || LockFree, LockFree>,
+            Backing,
+            Policies::DefaultStats,
+            Policies::Slots<FreeList, Hierarchical, Dense>,
+            Policies::Reclamation<Deferred>>>;
+
+    ////////////////////////////////////////////////
+    // MagazineAllocator
+    //  Thread local caches of reserved slot indices in front of a shared FixedTypeAllocator.
+    //  Get() / Pop() only touch the calling thread's magazine, which is refilled / drained
+    //  in batches of Depth / 2. Parked slots stay marked in the backing LUT, so ForAll on the
+    //  backing allocator is not meant to be mixed with this layer
+    template <
+            typename Type,
+            uint64_t Depth      = 32U,
+            typename Backing    = FixedTypeAllocator<Type, 1024U, AllocatorPolicy<Policies::Fixed, Policies::LockFree>>>
+    class MagazineAllocator
+        : public Allocator
+    {
+        static_assert(Depth >= 2U, "Magazines move half their depth at a time");
+        static_assert(Backing::StableAddresses, "Objects are built outside the backing pool's lock, it must not move them");
+
+        // Outlives the allocator for threads that exit after it is gone
+        struct Shared
+        {
+            std::mutex mutex;
+            Backing *pBacking = nullptr;
+        };
+
+        struct Magazine
+        {
+            std::shared_ptr<Shared> pShared;
+            uint64_t count = 0U;
+            std::array<uint64_t, Depth> slots{};
+        };
+
+        // Flush on thread exit, magazines whose allocator is still around go back to it
+        struct ThreadMagazines
+        {
+            ~ThreadMagazines()
+            {
+                for (auto &magazine : magazines)
+                    Flush(magazine);
+            }
+
+            std::vector<Magazine> magazines;
+        };
+
+    public:
+        MagazineAllocator()
+            : m_pShared(std::make_shared<Shared>())
+        {
+            m_pShared->pBacking = &m_Backing;
+        }
+
+        ~MagazineAllocator()
+        {
+            // Slots parked in other threads die with the backing pool
+            std::lock_guard<std::mutex> guard(m_pShared->mutex);
+            m_pShared->pBacking = nullptr;
+        }
+
+        MagazineAllocator(const MagazineAllocator&) = delete;
+        MagazineAllocator& operator=(const MagazineAllocator&) = delete;
+
+        [[nodiscard]] constexpr auto Internal() noexcept -> Backing* { return &m_Backing; }
+
+        template<typename ...Args>
+        [[nodiscard]] auto Get(Args&& ...args) -> OffsetPtr<Type>
+        {
+            Magazine &magazine = LocalMagazine();
+
+            if (magazine.count == 0U)
+            {
+                magazine.count = m_Backing.ReserveSlots(magazine.slots.data(), Depth / 2U);
+
+                // Backing pool is full
+                if (magazine.count == 0U)
+                    return OffsetPtr<Type>{};
+            }
+
+            const uint64_t index = magazine.slots[--magazine.count];
+            new (m_Backing.Slot(index))Type(std::forward<Args>(args)...);
+
+            return OffsetPtr<Type>(m_Backing.Internal(), index);
+        }
+
+        // element must come from Get() and not have been popped yet. Parked slots stay marked
+        //  in the backing LUT, so a second Pop() of the same slot can't be told apart from a
+        //  live one. It would run ~Type() twice and park the index twice
+        void Pop(OffsetPtr<Type>& element)
+        {
+            const uint64_t index = element.Internal();
+
+            if (element.Container() != m_Backing.Internal())
+                throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+
+            Magazine &magazine = LocalMagazine();
+
+            // Full magazine, hand the older half back to the shared pool
+            if (magazine.count == Depth)
+            {
+                m_Backing.ReleaseSlots(magazine.slots.data(), Depth / 2U);
+                std::copy(magazine.slots.begin() + Depth / 2U, magazine.slots.end(), magazine.slots.begin());
+                magazine.count -= Depth / 2U;
+            }
+
+            element.Resolve()->~Type();
+            magazine.slots[magazine.count++] = index;
+            element.ZeroOut();
+        }
+
+        // Returns every slot parked by the calling thread, for job systems that recycle
+        //  threads instead of letting them exit
+        void FlushThread()
+        {
+            Flush(LocalMagazine());
+        }
+
+    private:
+        static void Flush(Magazine &magazine)
+        {
+            if (!magazine.pShared)
+                return;
+
+            std::lock_guard<std::mutex> guard(magazine.pShared->mutex);
+
+            if (magazine.pShared->pBacking)
+                magazine.pShared->pBacking->ReleaseSlots(magazine.slots.data(), magazine.count);
+
+            magazine.count = 0U;
+        }
+
+        [[nodiscard]] auto LocalMagazine() -> Magazine&
+        {
+            auto &magazines = s_ThreadMagazines.magazines;
+
+            for (auto &magazine : magazines)
+            {
+                if (magazine.pShared == m_pShared)
+                    return magazine;
+            }
+
+            // First use on this thread, drop entries of allocators that are gone
+            magazines.erase(std::remove_if(magazines.begin(), magazines.end(), [](const Magazine &magazine) {
+                std::lock_guard<std::mutex> guard(magazine.pShared->mutex);
+                return magazine.pShared->pBacking == nullptr;
+            }), magazines.end());
+
+            magazines.push_back(Magazine{ m_pShared });
+            return magazines.back();
+        }
+
+        Backing m_Backing;
+        std::shared_ptr<Shared> m_pShared;
+
+        static thread_local ThreadMagazines s_ThreadMagazines;
+    };
+
+    template <typename Type, uint64_t Depth, typename Backing>
+    thread_local typename MagazineAllocator<Type, Depth, Backing>::ThreadMagazines MagazineAllocator<Type, Depth, Backing>::s_ThreadMagazines{};
+
+    ////////////////////////////////////////////////
+    // SoaAllocator
+    //  Structure of arrays pool, one stream per field type. All streams share a single LUT
+    //  and index space, slot i of the allocator is element i of every stream. Streams start
+    //  on a cache line and are padded to whole 64 slot blocks, so a kernel may always load
+    //  all 64 lanes of a block and mask out the inactive ones
+    template <uint64_t Size, bool Reallocates, typename ...Fields>
+    class SoaAllocator
+        : public Allocator
+    {
+        static_assert(sizeof...(Fields) > 0, "SoaAllocator needs at least one field stream");
+        static_assert((std::is_trivially_copyable_v<Fields> && ...), "Streams are grown with memcpy, fields must be trivially copyable");
+        static_assert(Size > 0, "SoaAllocator needs a non zero initial capacity");
+
+    public:
+        static constexpr uint64_t InvalidIndex      = ~0ULL;
+        static constexpr uint64_t StreamAlignment   = 64U;
+
+        template<uint64_t I>
+        using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+        // Up to 64 consecutive slots, bit i of mask is set when slot first + i is active
+        struct Block
+        {
+            uint64_t first;
+            uint64_t count;
+            uint64_t mask;
+            std::tuple<Fields*...> streams;
+
+            template<uint64_t I>
+            [[nodiscard]] auto Stream() const noexcept -> FieldType<I>* { return std::get<I>(streams); }
+
+            // Every lane active, the kernel needs no mask at all
+            [[nodiscard]] auto Full() const noexcept -> bool { return mask == ~0ULL; }
+        };
+
+        SoaAllocator()
+            : m_Lut(Bits::LutWords(Size), 0U)
+            , m_Capacity(Size)
+        {
+            std::apply([this](auto *&...pStreams) { ((pStreams = AllocStream(pStreams, 0U)), ...); }, m_Streams);
+        }
+
+        ~SoaAllocator()
+        {
+            std::apply([](auto *...pStreams) { (AlignedAllocator::Dealloc(pStreams), ...); }, m_Streams);
+        }
+
+        SoaAllocator(const SoaAllocator&) = delete;
+        SoaAllocator& operator=(const SoaAllocator&) = delete;
+
+        // Slot index with every field value initialized, InvalidIndex when full and not reallocating
+        [[nodiscard]] auto Get() -> uint64_t
+        {
+            if (m_Size + 1U > m_Capacity)
+            {
+                if constexpr (Reallocates)
+                    Reallocate();
+                else
+                    return InvalidIndex;
+            }
+
+            // Words below the hint are full
+            while (~m_Lut[m_FreeHint] == 0U)
+                m_FreeHint++;
+
+            const uint64_t index = m_FreeHint * Bits::WordBits + Bits::CountTrailingZeros(~m_Lut[m_FreeHint]);
+
+            m_Lut[m_FreeHint] |= (1ULL << (index % Bits::WordBits));
+            m_Size++;
+
+            std::apply([index](auto *...pStreams) { ((pStreams[index] = std::remove_pointer_t<decltype(pStreams)>{}), ...); }, m_Streams);
+
+            return index;
+        }
+
+        void Pop(uint64_t index)
+        {
+            if (index >= m_Capacity)
+                throw std::out_of_range("Index out of bounds of soa pool...");
+
+            const uint64_t w = index / Bits::WordBits;
+            const uint64_t flag = (1ULL << (index % Bits::WordBits));
+
+            if (m_Lut[w] & flag)
+            {
+                m_Lut[w] &= ~flag;
+                m_Size--;
+                m_FreeHint = std::min(m_FreeHint, w);
+            }
+        }
+
+        [[nodiscard]] auto IsActive(uint64_t index) const noexcept -> bool
+        {
+            return index < m_Capacity && ((m_Lut[index / Bits::WordBits] >> (index % Bits::WordBits)) & 1U);
+        }
+
+        template<uint64_t I>
+        [[nodiscard]] auto Field(uint64_t index) noexcept -> FieldType<I>& { return std::get<I>(m_Streams)[index]; }
+
+        // Base of a whole stream, valid until the next growth
+        template<uint64_t I>
+        [[nodiscard]] auto Stream() noexcept -> FieldType<I>* { return std::get<I>(m_Streams); }
+
+        [[nodiscard]] auto Count() const noexcept -> uint64_t { return m_Size; }
+        [[nodiscard]] auto Capacity() const noexcept -> uint64_t { return m_Capacity; }
+
+        // Hands out every block with at least one active slot, in index order
+        template<typename Func>
+        void ForEachBlock(Func&& f)
+        {
+            const uint64_t lutWords = m_Lut.size();
+
+            for (uint64_t w = 0; w < lutWords; ++w)
+            {
+                if (m_Lut[w] == 0U)
+                    continue;
+
+                const uint64_t first = w * Bits::WordBits;
+
+                Block block{ first, std::min(Bits::WordBits, m_Capacity - first), m_Lut[w],
+                    std::apply([first](auto *...pStreams) { return std::tuple<Fields*...>(pStreams + first...); }, m_Streams) };
+
+                f(block);
+            }
+        }
+
+        // Per slot convenience, f(Fields&...) for every active slot
+        template<typename Func>
+        void ForAll(Func&& f)
+        {
+            ForEachBlock([&f](const Block& block) {
+                for (uint64_t word = block.mask; word != 0U; word &= word - 1U)
+                {
+                    const uint64_t lane = Bits::CountTrailingZeros(word);
+                    std::apply([&f, lane](auto *...pStreams) { f(pStreams[lane]...); }, block.streams);
+                }
+            });
+        }
+
+    private:
+        // Fresh stream of m_Capacity elements, rounded up to whole blocks, keeping the first count of pOld
+        template<typename Field>
+        [[nodiscard]] auto AllocStream(Field *pOld, uint64_t count) -> Field*
+        {
+            const uint64_t elements = Bits::LutWords(m_Capacity) * Bits::WordBits;
+            auto pStream = static_cast<Field*>(AlignedAllocator::AllocZeroed(elements * sizeof(Field), StreamAlignment));
+
+            if (pOld)
+            {
+                std::memcpy(pStream, pOld, count * sizeof(Field));
+                AlignedAllocator::Dealloc(pOld);
+            }
+
+            return pStream;
+        }
+
+        void Reallocate()
+        {
+            const uint64_t oldCapacity = m_Capacity;
+            m_Capacity *= 2;
+
+            m_Lut.resize(Bits::LutWords(m_Capacity), 0U);
+            std::apply([this, oldCapacity](auto *&...pStreams) { ((pStreams = AllocStream(pStreams, oldCapacity)), ...); }, m_Streams);
+        }
+
+        std::vector<uint64_t> m_Lut;
+        std::tuple<Fields*...> m_Streams{};
+
+        uint64_t m_Capacity = 0U;
+        uint64_t m_Size     = 0U;
+        uint64_t m_FreeHint = 0U;
+    };
+
+    ////////////////////////////////////////////////
+    // ArenaAllocator
+    //  Monotonic bump allocator over a chain of AlignedAllocator blocks. Nothing is freed
+    //  on its own, Reset() / Rewind() drop everything past a point in O(1) and keep the
+    //  blocks for the next pass. Destructors of objects built here never run
+    class ArenaAllocator
+        : public Allocator
+    {
+        struct Block
+        {
+            Block *pNext;
+            uint64_t size;
+        };
+
+    public:
+        static constexpr uint64_t DefaultBlockSize  = 64U * 1024U;
+        static constexpr uint64_t HeaderBytes       = 64U;
+
+        // Position in the arena, everything allocated after it goes away on Rewind()
+        struct Marker
+        {
+            Block *pBlock;
+            uint64_t offset;
+        };
+
+        // Rewinds to where it was made when it goes out of scope
+        class Scope
+        {
+        public:
+            explicit Scope(ArenaAllocator& arena) noexcept
+                : m_pArena(&arena)
+                , m_Marker(arena.GetMarker())
+            {
+            }
+
+            ~Scope() { m_pArena->Rewind(m_Marker); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            ArenaAllocator *m_pArena;
+            Marker m_Marker;
+        };
+
+        explicit ArenaAllocator(uint64_t blockSize = DefaultBlockSize)
+            : m_BlockSize(std::max(blockSize, HeaderBytes * 2U))
+        {
+        }
+
+        ~ArenaAllocator()
+        {
+            while (m_pFirst)
+            {
+                Block *pNext = m_pFirst->pNext;
+                AlignedAllocator::Dealloc(m_pFirst);
+                m_pFirst = pNext;
+            }
+        }
+
+        ArenaAllocator(const ArenaAllocator&) = delete;
+        ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+        // align must be a power of two. Blocks are only cache line aligned, so the address is
+        //  aligned rather than the offset into the block
+        [[nodiscard]] auto Alloc(uint64_t size, uint64_t align = alignof(std::max_align_t)) -> void*
+        {
+            if (m_pCurrent)
+            {
+                const uintptr_t base    = reinterpret_cast<uintptr_t>(m_pCurrent);
+                const uint64_t offset   = ((base + m_Offset + align - 1U) & ~(align - 1U)) - base;
+
+                // Common case, a bump inside the current block
+                if (offset + size <= m_pCurrent->size)
+                {
+                    m_Offset = offset + size;
+                    return reinterpret_cast<uint8_t*>(m_pCurrent) + offset;
+                }
+            }
+
+            NextBlock(size, align);
+            return Alloc(size, align);
+        }
+
+        template<typename Type, typename ...Args>
+        [[nodiscard]] auto New(Args&& ...args) -> Type*
+        {
+            return new (Alloc(sizeof(Type), alignof(Type)))Type(std::forward<Args>(args)...);
+        }
+
+        // Value initialized
+        template<typename Type>
+        [[nodiscard]] auto NewArray(uint64_t count) -> Type*
+        {
+            return new (Alloc(sizeof(Type) * count, alignof(Type)))Type[count]();
+        }
+
+        [[nodiscard]] auto GetMarker() const noexcept -> Marker { return Marker{ m_pCurrent, m_Offset }; }
+
+        void Rewind(const Marker& marker) noexcept
+        {
+            m_pCurrent  = marker.pBlock;
+            m_Offset    = marker.offset;
+        }
+
+        void Reset() noexcept
+        {
+            m_pCurrent  = m_pFirst;
+            m_Offset    = HeaderBytes;
+        }
+
+        // Bytes reserved from AlignedAllocator over all blocks
+        [[nodiscard]] auto Reserved() const noexcept -> uint64_t
+        {
+            uint64_t bytes = 0U;
+
+            for (Block *pBlock = m_pFirst; pBlock; pBlock = pBlock->pNext)
+                bytes += pBlock->size;
+
+            return bytes;
+        }
+
+    private:
+        // Moves on to the next kept block that fits, or links a new one right after the current
+        void NextBlock(uint64_t size, uint64_t align)
+        {
+            const uint64_t needed = HeaderBytes + size + align;
+            Block *pNext = m_pCurrent ? m_pCurrent->pNext : m_pFirst;
+
+            while (pNext && pNext->size < needed)
+                pNext = pNext->pNext;
+
+            if (!pNext)
+            {
+                const uint64_t bytes = std::max(m_BlockSize, needed);
+                pNext = static_cast<Block*>(AlignedAllocator::Alloc(bytes, HeaderBytes));
+
+                if (!pNext)
+                    throw std::bad_alloc();
+
+                pNext->size = bytes;
+
+                if (m_pCurrent)
+                {
+                    pNext->pNext = m_pCurrent->pNext;
+                    m_pCurrent->pNext = pNext;
+                }
+                else
+                {
+                    pNext->pNext = m_pFirst;
+                    m_pFirst = pNext;
+                }
+            }
+
+            m_pCurrent  = pNext;
+            m_Offset    = HeaderBytes;
+        }
+
+        Block *m_pFirst     = nullptr;
+        Block *m_pCurrent   = nullptr;
+        uint64_t m_Offset   = HeaderBytes;
+        uint64_t m_BlockSize;
+    };
+
+    ////////////////////////////////////////////////
+    // FrameArena
+    //  Frames arenas in rotation. NextFrame() moves on and resets the arena it lands on, so
+    //  data from the previous Frames - 1 frames stays readable. One per thread, not shared
+    template<uint64_t Frames = 2U>
+    class FrameArena
+        : public Allocator
+    {
+        static_assert(Frames >= 2U, "A frame arena needs at least two buffers");
+
+    public:
+        explicit FrameArena(uint64_t blockSize = ArenaAllocator::DefaultBlockSize)
+            : m_Arenas(MakeArenas(blockSize, std::make_index_sequence<Frames>{}))
+        {
+        }
+
+        [[nodiscard]] auto Current() noexcept -> ArenaAllocator& { return m_Arenas[m_Frame % Frames]; }
+        [[nodiscard]] auto Previous() noexcept -> ArenaAllocator& { return m_Arenas[(m_Frame + Frames - 1U) % Frames]; }
+
+        void NextFrame() noexcept
+        {
+            m_Frame++;
+            Current().Reset();
+        }
+
+        [[nodiscard]] auto Alloc(uint64_t size, uint64_t align = alignof(std::max_align_t)) -> void* { return Current().Alloc(size, align); }
+
+        template<typename Type, typename ...Args>
+        [[nodiscard]] auto New(Args&& ...args) -> Type* { return Current().template New<Type>(std::forward<Args>(args)...); }
+
+    private:
+        template<size_t ...I>
+        [[nodiscard]] static auto MakeArenas(uint64_t blockSize, std::index_sequence<I...>) -> std::array<ArenaAllocator, Frames>
+        {
+            return { ((void)I, ArenaAllocator(blockSize))... };
+        }
+
+        std::array<ArenaAllocator, Frames> m_Arenas;
+        uint64_t m_Frame = 0U;
+    };
+
+    ////////////////////////////////////////////////
+    // StackAllocator
+    //  LIFO allocator over one fixed AlignedAllocator block. Allocation is an align and a
+    //  bump, freeing is rewinding to a marker, so there is no fragmentation. Destructors of
+    //  objects built here never run
+    class StackAllocator
+        : public Allocator
+    {
+    public:
+        using Marker = uint64_t;
+
+        static constexpr uint64_t BlockAlignment = 64U;
+
+        explicit StackAllocator(uint64_t bytes)
+            : m_pBlock(static_cast<uint8_t*>(AlignedAllocator::Alloc(bytes, BlockAlignment)))
+            , m_Capacity(bytes)
+        {
+            if (!m_pBlock)
+                throw std::bad_alloc();
+        }
+
+        ~StackAllocator()
+        {
+            AlignedAllocator::Dealloc(m_pBlock);
+        }
+
+        StackAllocator(const StackAllocator&) = delete;
+        StackAllocator& operator=(const StackAllocator&) = delete;
+
+        // align must be a power of two, larger than BlockAlignment pays for it in padding
+        [[nodiscard]] auto Alloc(uint64_t size, uint64_t align = alignof(std::max_align_t)) -> void*
+        {
+            const uintptr_t base    = reinterpret_cast<uintptr_t>(m_pBlock);
+            const uint64_t offset   = ((base + m_Top + align - 1U) & ~(align - 1U)) - base;
+
+            if (offset + size > m_Capacity)
+                throw std::bad_alloc();
+
+            m_Top = offset + size;
+            return m_pBlock + offset;
+        }
+
+        template<typename Type, typename ...Args>
+        [[nodiscard]] auto New(Args&& ...args) -> Type*
+        {
+            return new (Alloc(sizeof(Type), alignof(Type)))Type(std::forward<Args>(args)...);
+        }
+
+        // Value initialized
+        template<typename Type>
+        [[nodiscard]] auto NewArray(uint64_t count) -> Type*
+        {
+            return new (Alloc(sizeof(Type) * count, alignof(Type)))Type[count]();
+        }
+
+        [[nodiscard]] auto GetMarker() const noexcept -> Marker { return m_Top; }
+
+        // Frees everything allocated after the marker was taken
+        void FreeToMarker(Marker marker) noexcept { m_Top = std::min(marker, m_Top); }
+        void Clear() noexcept { m_Top = 0U; }
+
+        [[nodiscard]] auto Used() const noexcept -> uint64_t { return m_Top; }
+        [[nodiscard]] auto Capacity() const noexcept -> uint64_t { return m_Capacity; }
+
+    private:
+        uint8_t *m_pBlock;
+        uint64_t m_Capacity;
+        uint64_t m_Top = 0U;
+    };
+
+    ////////////////////////////////////////////////
+    // DoubleEndedStackAllocator
+    //  Two stacks sharing one block, Bottom grows up from the start (level data that lives
+    //  long) and Top grows down from the end (transient data). Full when they meet
+    enum class StackEnd : uint8_t
+    {
+        Bottom,
+        Top
+    };
+
+    class DoubleEndedStackAllocator
+        : public Allocator
+    {
+    public:
+        using Marker = uint64_t;
+
+        static constexpr uint64_t BlockAlignment = 64U;
+
+        explicit DoubleEndedStackAllocator(uint64_t bytes)
+            : m_pBlock(static_cast<uint8_t*>(AlignedAllocator::Alloc(bytes, BlockAlignment)))
+            , m_Capacity(bytes)
+            , m_Top(bytes)
+        {
+            if (!m_pBlock)
+                throw std::bad_alloc();
+        }
+
+        ~DoubleEndedStackAllocator()
+        {
+            AlignedAllocator::Dealloc(m_pBlock);
+        }
+
+        DoubleEndedStackAllocator(const DoubleEndedStackAllocator&) = delete;
+        DoubleEndedStackAllocator& operator=(const DoubleEndedStackAllocator&) = delete;
+
+        // align must be a power of two, larger than BlockAlignment pays for it in padding
+        template<StackEnd End = StackEnd::Bottom>
+        [[nodiscard]] auto Alloc(uint64_t size, uint64_t align = alignof(std::max_align_t)) -> void*
+        {
+            const uintptr_t base = reinterpret_cast<uintptr_t>(m_pBlock);
+
+            if constexpr (End == StackEnd::Bottom)
+            {
+                const uint64_t offset = ((base + m_Bottom + align - 1U) & ~(align - 1U)) - base;
+
+                if (offset + size > m_Top)
+                    throw std::bad_alloc();
+
+                m_Bottom = offset + size;
+                return m_pBlock + offset;
+            }
+            else
+            {
+                if (size > m_Top)
+                    throw std::bad_alloc();
+
+                const uintptr_t address = (base + m_Top - size) & ~(align - 1U);
+
+                if (address < base + m_Bottom)
+                    throw std::bad_alloc();
+
+                const uint64_t offset = address - base;
+
+                m_Top = offset;
+                return m_pBlock + offset;
+            }
+        }
+
+        template<typename Type, StackEnd End = StackEnd::Bottom, typename ...Args>
+        [[nodiscard]] auto New(Args&& ...args) -> Type*
+        {
+            return new (Alloc<End>(sizeof(Type), alignof(Type)))Type(std::forward<Args>(args)...);
+        }
+
+        // Value initialized
+        template<typename Type, StackEnd End = StackEnd::Bottom>
+        [[nodiscard]] auto NewArray(uint64_t count) -> Type*
+        {
+            return new (Alloc<End>(sizeof(Type) * count, alignof(Type)))Type[count]();
+        }
+
+        template<StackEnd End = StackEnd::Bottom>
+        [[nodiscard]] auto GetMarker() const noexcept -> Marker
+        {
+            if constexpr (End == StackEnd::Bottom)
+                return m_Bottom;
+            else
+                return m_Top;
+        }
+
+        // Frees everything allocated on that end after the marker was taken
+        template<StackEnd End = StackEnd::Bottom>
+        void FreeToMarker(Marker marker) noexcept
+        {
+            if constexpr (End == StackEnd::Bottom)
+                m_Bottom = std::min(marker, m_Bottom);
+            else
+                m_Top = std::max(marker, m_Top);
+        }
+
+        template<StackEnd End = StackEnd::Bottom>
+        void Clear() noexcept
+        {
+            if constexpr (End == StackEnd::Bottom)
+                m_Bottom = 0U;
+            else
+                m_Top = m_Capacity;
+        }
+
+        [[nodiscard]] auto Free() const noexcept -> uint64_t { return m_Top - m_Bottom; }
+        [[nodiscard]] auto Capacity() const noexcept -> uint64_t { return m_Capacity; }
+
+    private:
+        uint8_t *m_pBlock;
+        uint64_t m_Capacity;
+        uint64_t m_Bottom = 0U;
+        uint64_t m_Top;
+    };
+
+    ////////////////////////////////////////////////
+    // SizeClasses
+    //  Geometric size class table, 8, 16, then steps of 16 up to 128 and four classes per
+    //  doubling after that (160, 192, 224, 256, 320, ...) up to MaxSize
+    namespace SizeClasses
+    {
+        static constexpr uint64_t MaxSize = 16384U;
+
+        [[nodiscard]] constexpr auto Next(uint64_t size) noexcept -> uint64_t
+        {
+            if (size < 32U)
+                return size * 2U;
+
+            uint64_t group = 32U;
+
+            while (group * 2U <= size)
+                group *= 2U;
+
+            return size + std::max<uint64_t>(16U, group / 4U);
+        }
+
+        [[nodiscard]] constexpr auto CountClasses() noexcept -> uint64_t
+        {
+            uint64_t count = 0U;
+
+            for (uint64_t size = 8U; size <= MaxSize; size = Next(size))
+                count++;
+
+            return count;
+        }
+
+        static constexpr uint64_t Count = CountClasses();
+
+        [[nodiscard]] constexpr auto BuildSizes() noexcept -> std::array<uint64_t, Count>
+        {
+            std::array<uint64_t, Count> sizes{};
+            uint64_t size = 8U;
+
+            for (uint64_t i = 0; i < Count; ++i, size = Next(size))
+                sizes[i] = size;
+
+            return sizes;
+        }
+
+        static constexpr std::array<uint64_t, Count> Sizes = BuildSizes();
+
+        // Every class past the first is a multiple of 16, so one entry per 16 bytes is exact
+        [[nodiscard]] constexpr auto BuildLookup() noexcept -> std::array<uint8_t, MaxSize / 16U + 1U>
+        {
+            std::array<uint8_t, MaxSize / 16U + 1U> lookup{};
+            uint64_t sizeClass = 1U;
+
+            for (uint64_t bucket = 1U; bucket < lookup.size(); ++bucket)
+            {
+                while (Sizes[sizeClass] < bucket * 16U)
+                    sizeClass++;
+
+                lookup[bucket] = static_cast<uint8_t>(sizeClass);
+            }
+
+            return lookup;
+        }
+
+        static constexpr std::array<uint8_t, MaxSize / 16U + 1U> Lookup = BuildLookup();
+
+        // Smallest class holding size bytes, size must not exceed MaxSize
+        [[nodiscard]] constexpr auto Index(uint64_t size) noexcept -> uint64_t
+        {
+            return size <= 8U ? 0U : Lookup[(size + 15U) / 16U];
+        }
+    }
+
+    ////////////////////////////////////////////////
+    // FixedSizeAllocator
+    //  One pool per size class, Size rounds up through SizeClasses so GetPool<13>() and
+    //  GetPool<16>() share a pool. Pool backed class pools are constant initialized statics
+    //  that allocate on their first Get(), GetAllocator() is a plain address with no guard
+    //  and other static initializers may use them too. Other backings fall back to a
+    //  function local static
+    template<uint64_t Size>
+    struct Padding
+    {
+    private:
+        uint8_t internal[Size];
+    };
+
+    template<typename Policy = AllocatorPolicy<>>
+    class BasicFsa
+        : public Allocator
+    {
+        static_assert(std::is_constructible_v<typename Policy::Backing, uint64_t, uint64_t>, "Fsa pools are built from size and capacity alone");
+
+    public:
+        // Sizes past the table get a pool of their own, rounded to 16 bytes
+        template<uint64_t Size>
+        [[nodiscard]] static constexpr auto ClassSize() noexcept -> uint64_t
+        {
+            static_assert(Size > 0U, "Fsa needs a non zero size");
+
+            if constexpr (Size <= SizeClasses::MaxSize)
+                return SizeClasses::Sizes[SizeClasses::Index(Size)];
+            else
+                return (Size + 15U) & ~15ULL;
+        }
+
+        template<uint64_t Size, uint64_t Capacity = 1024U>
+        using SizedPool = FixedTypeAllocator<Padding<ClassSize<Size>()>, Capacity, Policy>;
+
+        // Typed front over the class pool, locks and grows the way Policy says
+        template<uint64_t Size, uint64_t Capacity = 1024U>
+        [[nodiscard]] static auto GetAllocator() -> SizedPool<Size, Capacity>*
+        {
+            return ClassPool<ClassSize<Size>(), Capacity>();
+        }
+
+        // Raw backing of the same pool, for callers that drive the LUT themselves. Allocated
+        //  first, those callers never go through a Get()
+        template<uint64_t Size, uint64_t Capacity = 1024U>
+        [[nodiscard]] static auto GetPool() -> typename Policy::Backing*
         {
-        }
+            auto pAllocator = GetAllocator<Size, Capacity>();
+            pAllocator->Allocate();
 
-        // Helpers
-        [[nodiscard]] constexpr auto Internal() noexcept -> uint64_t { return offset; }
-        [[nodiscard]] constexpr auto Container() noexcept -> PoolAllocator* { return pContainer; }
+            return pAllocator->Internal();
+        }
 
-        constexpr void ZeroOut() noexcept
+        // Map it back with MappedPool(ClassSize<Size>(), Capacity, path), Fsa pools are raw bytes already.
+        //  Goes through the pool's own Save() so the write excludes every Get() / Free() on it
+        template<uint64_t Size, uint64_t Capacity = 1024U>
+        static void Save(const char *path)
         {
-            offset = 0U;
-            pContainer = nullptr;
+            GetAllocator<Size, Capacity>()->Save(path);
         }
 
-        // Resolving
-        [[nodiscard]] constexpr auto Resolve() noexcept -> Type* { return static_cast<Type*>(pContainer->Internal()) + offset; }
-        constexpr Type* operator->() noexcept { return static_cast<Type*>(pContainer->Internal()) + offset; }
+        template<uint64_t Size, uint64_t Capacity = 1024U>
+        [[nodiscard]] static auto Stats() -> AllocatorStats
+        {
+            return GetAllocator<Size, Capacity>()->Stats();
+        }
 
     private:
-        uint64_t offset;
-        PoolAllocator *pContainer;
+        // Keyed by class, not by the Size asked for, so every Size of a class lands here
+        template<uint64_t Class, uint64_t Capacity>
+        [[nodiscard]] static auto ClassPool() -> SizedPool<Class, Capacity>*
+        {
+            if constexpr (SizedPool<Class, Capacity>::ConstantInitializable)
+                return &s_ClassPool<Class, Capacity>;
+            else
+            {
+                static SizedPool<Class, Capacity> pool{};
+                return &pool;
+            }
+        }
+
+        // Constant initialized, in place before any dynamic initializer runs
+        template<uint64_t Class, uint64_t Capacity>
+        static inline SizedPool<Class, Capacity> s_ClassPool{ Unallocated{} };
     };
 
-    template<typename Type>
-    using OPtr = OffsetPtr<Type>;
+    using Fsa = BasicFsa<>;
 
     ////////////////////////////////////////////////
-    // AlignedAllocator
-    class AlignedAllocator
+    // SlabHeap
+    //  Arbitrary size allocations without a size on free. Small requests come from SlabSize
+    //  aligned slabs of one size class, anything bigger gets a block of its own. Both start
+    //  with a header, so masking a pointer down to the slab boundary finds its size class
+    template<bool ThreadSafe = false, bool Counted = CollectStats>
+    class SlabHeap
         : public Allocator
     {
     public:
-        [[nodiscard]] static auto Alloc(size_t size, uint64_t alnm) -> void*
-        {
-            void *pMem = _aligned_malloc(size, alnm);
-            std::memset(pMem, 0, size);
-            return pMem;
-        }
-        
-        static void Dealloc(void *pPtr)
-        {
-            _aligned_free(pPtr);
-        }
-    };
-    
-    struct Pool
-        : public PoolAllocator, public Allocator
-    {
-        union
-        {
-            void *pLut;
-            void *pPoolBlockStart;
-        };
+        static constexpr uint64_t SlabSize          = 64U * 1024U;
+        static constexpr uint64_t HeaderBytes       = 64U;
+        static constexpr uint64_t LargeClass        = SizeClasses::Count;
 
-        void *pMem              = nullptr;
-        uint64_t capacity       = 0U;
-        uint64_t size           = 0U;
-        uint64_t poolItemSize   = 0U;
+        SlabHeap() = default;
 
-        Pool()
+        ~SlabHeap()
         {
-            capacity        = 0U;
-            size            = 0U;
-            poolItemSize    = 0U;
-            pLut            = nullptr;
-            pMem            = nullptr;
+            for (auto &state : m_Classes)
+            {
+                ReleaseList(state.pPartial);
+                ReleaseList(state.pFull);
+            }
+
+            ReleaseList(m_pLarge);
         }
 
-        explicit Pool(uint64_t elementSize, uint64_t poolCapacity = 1024U)
+        SlabHeap(const SlabHeap&) = delete;
+        SlabHeap& operator=(const SlabHeap&) = delete;
+
+        // align must be a power of two below SlabSize
+        [[nodiscard]] auto Alloc(size_t size, size_t align = alignof(std::max_align_t)) -> void*
         {
-            void *pMemory = AlignedAllocator::Alloc((poolCapacity / 8U) + (elementSize * poolCapacity), elementSize);
+            if (align == 0U || (align & (align - 1U)) != 0U || align >= SlabSize)
+                throw std::bad_alloc();
 
-            capacity        = poolCapacity;
-            size            = 0U;
-            poolItemSize    = elementSize;
-            pLut            = pMemory;
-            pMem            = static_cast<uint8_t*>(pMemory) + (poolCapacity / 8U);
+            // Slots sit HeaderBytes past a slab boundary, a class gives the alignment of its size up to that
+            if (size <= SizeClasses::MaxSize && align <= HeaderBytes)
+            {
+                uint64_t sizeClass = SizeClasses::Index(std::max<uint64_t>(std::max<uint64_t>(size, align), 1U));
+
+                while (sizeClass < SizeClasses::Count && SizeClasses::Sizes[sizeClass] % align != 0U)
+                    sizeClass++;
+
+                if (sizeClass < SizeClasses::Count)
+                    return AllocSmall(sizeClass);
+            }
+
+            return AllocLarge(size, align);
         }
 
-        void Reallocate()
+        void Free(void *pMem)
         {
-            Pool old(*this);
+            if (!pMem)
+                return;
 
-            // Duplicate capacity
-            capacity *= 2;
+            SlabHeader *pSlab = Header(pMem);
 
-            // Reallocate and assign accordingly
-            void *pNewMemory = AlignedAllocator::Alloc((capacity / 8U) + (poolItemSize * capacity), poolItemSize);
+            if (pSlab->pOwner != this)
+                throw std::out_of_range("Address of pMem was not allocated by this heap...");
 
-            pLut = pNewMemory;
-            pMem = static_cast<uint8_t*>(pNewMemory) + (capacity / 8U);
+            m_ClassStats[pSlab->sizeClass].OnFree();
+
+            if (pSlab->sizeClass == LargeClass)
+            {
+                auto lock = Lock(m_LargeMutex, LargeClass);
+                Unlink(m_pLarge, pSlab);
+                AlignedAllocator::Dealloc(pSlab);
+                return;
+            }
 
-            // Copy over old LUT
-            std::memcpy(pPoolBlockStart, old.pPoolBlockStart, old.capacity / 8U);
+            auto &state = m_Classes[pSlab->sizeClass];
+            auto lock = Lock(state.mutex, pSlab->sizeClass);
 
-            // Copy over old pool
-            std::memcpy(pMem, old.pMem, old.poolItemSize * old.capacity);
+            const bool wasFull = pSlab->live == SlotsPerSlab(pSlab->sizeClass);
+
+            // Dead slot holds the next free slot
+            std::memcpy(pMem, &pSlab->pFree, sizeof(void*));
+            pSlab->pFree = pMem;
+            pSlab->live--;
 
-            // Old goes out of scope and is freed
+            if (wasFull)
+            {
+                Unlink(state.pFull, pSlab);
+                Link(state.pPartial, pSlab);
+            }
+            else if (pSlab->live == 0U && (state.pPartial != pSlab || pSlab->pNext))
+            {
+                // Keep one empty slab per class around, give the rest back
+                Unlink(state.pPartial, pSlab);
+                AlignedAllocator::Dealloc(pSlab);
+            }
         }
 
-        [[nodiscard]] constexpr auto Internal() noexcept -> void* override { return pMem; };
+        // Bytes the allocation can actually hold, at least what was asked for
+        [[nodiscard]] static auto UsableSize(const void *pMem) noexcept -> uint64_t
+        {
+            return Header(pMem)->slotSize;
+        }
 
-        ~Pool()
+        // One entry per size class and a last one for large blocks, all zero without ALC_STATS
+        [[nodiscard]] auto Stats() const -> std::array<AllocatorStats, SizeClasses::Count + 1U>
         {
-            AlignedAllocator::Dealloc(static_cast<uint8_t*>(pPoolBlockStart));
+            std::array<AllocatorStats, SizeClasses::Count + 1U> stats{};
+
+            for (uint64_t i = 0; i < stats.size(); ++i)
+                m_ClassStats[i].Fill(stats[i]);
+
+            return stats;
         }
 
     private:
-        Pool(const Pool& other)
+        struct SlabHeader
         {
-            pLut            = other.pLut;
-            pPoolBlockStart = other.pPoolBlockStart;
-            pMem            = other.pMem;
-            capacity        = other.capacity;
-            size            = other.size;
-            poolItemSize    = other.poolItemSize;
-        }
-    };
+            SlabHeap *pOwner;
+            SlabHeader *pPrev;
+            SlabHeader *pNext;
+            void *pFree;
+            uint64_t sizeClass;
+            uint64_t slotSize;
+            uint64_t live;
+            uint64_t bump;
+        };
 
-    ////////////////////////////////////////////////
-    // FixedSizeAllocator
-    class Fsa
-        : public Allocator
-    {
-    public:
-        template<uint64_t Size, uint64_t Capacity = 1024U>
-        [[nodiscard]] static auto GetPool() -> Pool*
+        static_assert(sizeof(SlabHeader) <= HeaderBytes, "Slab header must fit in front of the first slot");
+
+        struct ClassState
         {
-            static Pool p(Size, Capacity);
-            return &p;
-        }
-    };
+            std::mutex mutex;
+            SlabHeader *pPartial    = nullptr;
+            SlabHeader *pFull       = nullptr;
+        };
 
-    ////////////////////////////////////////////////
-    // Callbacks
-    using OnReallocateCallback = std::function<void()>;
+        [[nodiscard]] static auto Header(const void *pMem) noexcept -> SlabHeader*
+        {
+            return reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(pMem) & ~static_cast<uintptr_t>(SlabSize - 1U));
+        }
 
-    ////////////////////////////////////////////////
-    // FixedTypeAllocator
-    template <
-            typename Type,
-            uint64_t Size       = 1024U,
-            bool Reallocates    = true,
-            bool ThreadSafe     = false,
-            std::enable_if_t<constexpr_mod<Size, 8>::value == 0, int> = 0>
-    class FixedTypeAllocator
-        : public Allocator
-    {
-    public:
-        FixedTypeAllocator()
-            : m_Pool(sizeof(Type), Size)
+        [[nodiscard]] static constexpr auto SlotsPerSlab(uint64_t sizeClass) noexcept -> uint64_t
         {
+            return (SlabSize - HeaderBytes) / SizeClasses::Sizes[sizeClass];
         }
 
-        void SetOnReallocateCallback(const OnReallocateCallback& cb) { m_OnReallocateCallback = cb; }
+        [[nodiscard]] auto Lock(std::mutex& mutex, uint64_t sizeClass) -> std::unique_lock<std::mutex>
+        {
+            if constexpr (ThreadSafe)
+                return m_ClassStats[sizeClass].Lock(mutex);
+            else
+                return std::unique_lock<std::mutex>();
+        }
 
-        [[nodiscard]] constexpr auto Internal() noexcept -> Pool * { return &m_Pool; }
-        [[nodiscard]] constexpr auto Get() -> OffsetPtr<Type>
+        [[nodiscard]] auto AllocSmall(uint64_t sizeClass) -> void*
         {
-            // In case we're in a thread safe pool, lock
-            if constexpr(ThreadSafe)
-                m_Mutex.lock();
+            auto &state = m_Classes[sizeClass];
+            auto lock = Lock(state.mutex, sizeClass);
 
-            if (m_Pool.size + 1 > m_Pool.capacity)
+            SlabHeader *pSlab = state.pPartial;
+
+            if (!pSlab)
             {
-                if constexpr (Reallocates)
-                {
-                    m_Pool.Reallocate();
-                    m_OnReallocateCallback();
-                }
-                else
-                    return OffsetPtr<Type>{};
+                pSlab = NewHeader(AlignedAllocator::Alloc(SlabSize, SlabSize), sizeClass, SizeClasses::Sizes[sizeClass]);
+                Link(state.pPartial, pSlab);
+                m_ClassStats[sizeClass].OnReallocate();
             }
 
-            // Look up first available slot in pool
-            auto pLut = static_cast<uint8_t *>(m_Pool.pLut);
+            m_ClassStats[sizeClass].OnAlloc();
 
-            for (uint64_t i = 0; i < m_Pool.capacity / 8; ++i)
-            {
-                // Check pool map for inactive entities
-                for (uint64_t j = 0; j < 8; ++j)
-                {
-                    uint8_t flag = (1U << j);
+            void *pSlot = pSlab->pFree;
 
-                    // Check inverse byte against flag
-                    if (~(*pLut) & flag)
-                    {
-                        *pLut |= flag;
-                        m_Pool.size++;
+            // Reuse a freed slot first, otherwise take the next never used one
+            if (pSlot)
+                std::memcpy(&pSlab->pFree, pSlot, sizeof(void*));
+            else
+                pSlot = reinterpret_cast<uint8_t*>(pSlab) + HeaderBytes + pSlab->bump++ * pSlab->slotSize;
 
-                        // Once the lut and the pool size have been mutated,
-                        //  In case we're in a thread safe pool, unlock
-                        if constexpr(ThreadSafe)
-                            m_Mutex.unlock();
+            if (++pSlab->live == SlotsPerSlab(sizeClass))
+            {
+                Unlink(state.pPartial, pSlab);
+                Link(state.pFull, pSlab);
+            }
+
+            return pSlot;
+        }
 
-                        // Placement if to get an initialized object
-                        Type *pFreeObject = &static_cast<Type*>(m_Pool.pMem)[i * 8 + j];
-                        new (pFreeObject)Type();
+        // The payload starts less than SlabSize into its block, so Header() still finds it
+        [[nodiscard]] auto AllocLarge(uint64_t size, uint64_t align) -> void*
+        {
+            const uint64_t offset = std::max(HeaderBytes, align);
+            SlabHeader *pSlab = NewHeader(AlignedAllocator::Alloc(offset + size, SlabSize), LargeClass, size);
 
-                        OffsetPtr<Type> offsetPtr (&m_Pool, i * 8U + j);
+            auto lock = Lock(m_LargeMutex, LargeClass);
+            Link(m_pLarge, pSlab);
+            m_ClassStats[LargeClass].OnAlloc();
 
-                        return offsetPtr;
-                    }
-                }
+            return reinterpret_cast<uint8_t*>(pSlab) + offset;
+        }
 
-                pLut++;
-            }
+        [[nodiscard]] auto NewHeader(void *pBlock, uint64_t sizeClass, uint64_t slotSize) -> SlabHeader*
+        {
+            if (!pBlock)
+                throw std::bad_alloc();
 
-            // At this point something failed in the allocation
-            throw std::bad_alloc();
+            return new (pBlock)SlabHeader{ this, nullptr, nullptr, nullptr, sizeClass, slotSize, 0U, 0U };
         }
 
-        constexpr void Pop(OffsetPtr<Type>& element)
+        static void Link(SlabHeader *&pHead, SlabHeader *pSlab) noexcept
         {
-            // In case we're in a thread safe pool, lock
-            if constexpr(ThreadSafe)
-                m_Mutex.lock();
+            pSlab->pPrev = nullptr;
+            pSlab->pNext = pHead;
 
-            Type* pElement = element.Resolve();
+            if (pHead)
+                pHead->pPrev = pSlab;
 
-            if (pElement < m_Pool.pMem || pElement > static_cast<Type*>(m_Pool.pMem) + m_Pool.capacity)
-                throw std::out_of_range("Address of pElement out of bounds of memory pool...");
+            pHead = pSlab;
+        }
 
-            auto pLut       = static_cast<uint8_t*>(m_Pool.pLut);
-            auto pMemory    = static_cast<Type*>(m_Pool.pMem);
-            auto index      = static_cast<uint64_t>(pElement - pMemory);
+        static void Unlink(SlabHeader *&pHead, SlabHeader *pSlab) noexcept
+        {
+            if (pSlab->pPrev)
+                pSlab->pPrev->pNext = pSlab->pNext;
+            else
+                pHead = pSlab->pNext;
 
-            // Get box in look up table
-            uint8_t *pBox = &pLut[0];
-            uint8_t boxOffset = 0U;
+            if (pSlab->pNext)
+                pSlab->pNext->pPrev = pSlab->pPrev;
+        }
 
-            if (index != 0U)
+        static void ReleaseList(SlabHeader *pHead) noexcept
+        {
+            while (pHead)
             {
-                pBox = &pLut[(index / 8U) % m_Pool.capacity];
-                boxOffset = index % 8U;
+                SlabHeader *pNext = pHead->pNext;
+                AlignedAllocator::Dealloc(pHead);
+                pHead = pNext;
             }
+        }
 
-            // If item active, disable it
-            uint8_t flag = (1U << boxOffset);
-            if (*pBox & flag)
-            {
-                // Flip bit
-                *pBox ^= flag;
+        std::array<ClassState, SizeClasses::Count> m_Classes{};
 
-                // Decrease used size
-                m_Pool.size--;
+        std::mutex m_LargeMutex;
+        SlabHeader *m_pLarge = nullptr;
 
-                // Once the lut and the pool size have been mutated,
-                //  in case we're in a thread safe pool, unlock
-                if constexpr(ThreadSafe)
-                    m_Mutex.unlock();
+        ALC_NO_UNIQUE_ADDRESS StatsArray<Counted, SizeClasses::Count + 1U> m_ClassStats{};
+    };
 
-                // Since we're not calling delete, ~Type() is called manually
-                pMemory[index].~Type();
-                element.ZeroOut();
+    ////////////////////////////////////////////////
+    // GeneralPurposeAllocator
+    template<typename Policy,
+            uint64_t PoolSize   = 128U,
+            uint64_t ...SubPoolSize>
+    class BasicGeneralPurposeAllocator
+    {
+        static_assert(!Policy::LockFree, "Delete() destroys and releases under the sub pool lock, use Locked threading");
+
+        template<uint64_t Size>
+        using SubPool = FixedTypeAllocator<Padding<Size>, PoolSize, Policy>;
+
+    public:
+        static constexpr uint64_t SubPoolCount = sizeof...(SubPoolSize);
+        static constexpr std::array<uint64_t, SubPoolCount> SubPoolSizes{ SubPoolSize... };
+
+        // First sub pool that fits, resolved at compile time. SubPoolCount when none does
+        template<typename Type>
+        [[nodiscard]] static constexpr auto SizeClass() noexcept -> uint64_t
+        {
+            for (uint64_t i = 0; i < SubPoolCount; ++i)
+            {
+                if (sizeof(Type) <= SubPoolSizes[i])
+                    return i;
             }
+
+            return SubPoolCount;
         }
 
+        BasicGeneralPurposeAllocator() = default;
+
     private:
-        void ForAllActive(const std::function<void(Type*)>& f)
+        template<typename Type>
+        [[nodiscard]] auto ResolvePool() -> auto&
         {
-            if constexpr(ThreadSafe)
-                m_Mutex.lock();
+            static_assert(SizeClass<Type>() < SubPoolCount, "No sub pool is large enough for Type");
 
-            auto pPoolItem  = static_cast<Type*>(m_Pool.pMem);
-            auto pLut       = static_cast<uint8_t*>(m_Pool.pLut);
+            // Slots sit at pool base + index * sub pool size, the base is cache line aligned past the LUT
+            static_assert(alignof(Type) <= AlignedAllocator::CacheLineSize && SubPoolSizes[SizeClass<Type>()] % alignof(Type) == 0,
+                "Type needs more alignment than its sub pool slots provide");
 
-            for (uint64_t i = 0; i < m_Pool.capacity; ++i)
-            {
-                // Get box in look up table
-                uint8_t *pBox = &pLut[0];
-                uint8_t boxOffset = 0U;
+            return std::get<SizeClass<Type>()>(m_Pools);
+        }
 
-                if (i != 0U)
-                {
-                    pBox = &pLut[(i / 8) % Size];
-                    boxOffset = i % 8;
-                }
+    public:
+        // Type itself is built in the slot, the handle strides by the sub pool size through the real Pool
+        template<typename Type, typename ...Args>
+        [[nodiscard]] auto New(Args&& ...args) -> OffsetPtr<Type>
+        {
+            auto &ftPool = ResolvePool<Type>();
 
-                // If item active
-                uint8_t flag = (1U << boxOffset);
-                if (*pBox & flag)
-                    f(pPoolItem);
+            // Built by the sub pool while a concurrent New can't grow it away
+            auto slot = ftPool.Emplace([&](void *pSlot) { new (pSlot)Type(std::forward<Args>(args)...); });
 
-                pPoolItem++;
-            }
+            if (!slot.Container())
+                return OffsetPtr<Type>{};
 
-            if constexpr(ThreadSafe)
-                m_Mutex.unlock();
+            return OffsetPtr<Type> (ftPool.Internal(), slot.Internal());
         }
 
-        void ForAllFast(const std::function<void(Type*)>& f)
+        template<typename Type>
+        void Delete(OffsetPtr<Type>& oPtr)
         {
-            if constexpr(ThreadSafe)
-                m_Mutex.lock();
+            auto &ftPool = ResolvePool<Type>();
 
-            auto pPoolItem = static_cast<Type*>(m_Pool.pMem);
-
-            for (uint64_t i = 0; i < m_Pool.capacity; ++i)
-            {
-                f(pPoolItem);
-                ++pPoolItem;
-            }
+            if (oPtr.Container() != ftPool.Internal())
+                throw std::out_of_range("Address of pElement out of bounds of memory pool...");
 
-            if constexpr(ThreadSafe)
-                m_Mutex.unlock();
+            // The slot held a Type, not a Padding, so its destructor is ours to call
+            if (ftPool.Dispose(oPtr.Internal(), [](void *pSlot) { static_cast<Type*>(pSlot)->~Type(); }))
+                oPtr.ZeroOut();
         }
 
-    public:
-        template <bool IgnoreInactive = true>
-        void ForAll(const std::function<void(Type*)>& f)
+        // Runtime path for sizes only known at run time, malloc / free style
+        [[nodiscard]] auto Alloc(size_t size, size_t align = alignof(std::max_align_t)) -> void* { return m_Heap.Alloc(size, align); }
+        void Free(void *pMem) { m_Heap.Free(pMem); }
+
+        // Compile time sub pools in SubPoolSize order, then the runtime heap by size class
+        struct GpaStats
         {
-            if constexpr(IgnoreInactive)
-                ForAllActive(f);
-            else
-                ForAllFast(f);
-        }
+            std::array<AllocatorStats, SubPoolCount> subPools{};
+            std::array<AllocatorStats, SizeClasses::Count + 1U> heap{};
+        };
 
-    private:
-        Pool m_Pool;
-        OnReallocateCallback m_OnReallocateCallback = [](){};
-        std::mutex m_Mutex;
-    };
+        [[nodiscard]] auto Stats() -> GpaStats
+        {
+            GpaStats stats{};
+            uint64_t i = 0U;
+
+            std::apply([&](auto& ...pools) { ((stats.subPools[i++] = pools.Stats()), ...); }, m_Pools);
+            stats.heap = m_Heap.Stats();
+
+            return stats;
+        }
 
-    ////////////////////////////////////////////////
-    // GeneralPurposeAllocator
-    template<uint64_t Size>
-    struct Padding
-    {
     private:
-        uint8_t internal[Size];
+        // One pool per size class, laid out flat, no lookup on New() / Delete()
+        std::tuple<SubPool<SubPoolSize>...> m_Pools;
+        SlabHeap<Policy::ThreadSafe, Policy::Stats> m_Heap;
     };
 
     template<uint64_t PoolSize  = 128U,
             bool Reallocates    = true,
             bool ThreadSafe     = false,
             uint64_t ...SubPoolSize>
-    class GeneralPurposeAllocator
-    {
-    private:
-        template<uint64_t Size>
-        [[nodiscard]] auto AddPools() -> uint64_t
-        {
-            m_Pools[Size] = new FixedTypeAllocator<Padding<Size>, PoolSize, Reallocates, ThreadSafe>();
-            return Size;
-        }
+    using GeneralPurposeAllocator = BasicGeneralPurposeAllocator<
+            AllocatorPolicy<Policies::Growth<Reallocates>, Policies::Threading<ThreadSafe, false>>, PoolSize, SubPoolSize...>;
 
+    ////////////////////////////////////////////////
+    // GpaMemoryResource
+    //  std::pmr adapter over a GeneralPurposeAllocator's runtime Alloc / Free path, the
+    //  allocator must outlive every container using the resource
+    template<typename Gpa>
+    class GpaMemoryResource
+        : public std::pmr::memory_resource, public Allocator
+    {
     public:
-        GeneralPurposeAllocator()
+        explicit GpaMemoryResource(Gpa& gpa) noexcept
+            : m_pGpa(&gpa)
         {
-            constexpr auto subPoolCount = sizeof...(SubPoolSize);
-            if constexpr (subPoolCount > 0)
-            {
-                // Unwrapping with std::array
-                 m_SubPoolSizes = { AddPools<SubPoolSize>()... };
-            }
         }
 
     private:
-        template<typename Type>
-        [[nodiscard]] constexpr auto ResolvePool() -> uint64_t
+        [[nodiscard]] auto do_allocate(size_t bytes, size_t alignment) -> void* override
         {
-            constexpr auto subPoolCount = sizeof...(SubPoolSize);
-            constexpr auto typeSize     = sizeof(Type);
+            return m_pGpa->Alloc(bytes, alignment);
+        }
 
-            for (uint64_t i = 0; i < subPoolCount; ++i)
-            {
-                if (typeSize <= m_SubPoolSizes[i])
-                    return m_SubPoolSizes[i];
-            }
+        void do_deallocate(void *pMem, size_t, size_t) override
+        {
+            m_pGpa->Free(pMem);
+        }
 
-            throw std::bad_alloc();
+        [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override
+        {
+            auto pOther = dynamic_cast<const GpaMemoryResource*>(&other);
+            return pOther && pOther->m_pGpa == m_pGpa;
         }
 
+        Gpa *m_pGpa;
+    };
+
+    ////////////////////////////////////////////////
+    // PoolStlAllocator
+    //  STL allocator for node based containers. Single element requests (list / map / set
+    //  nodes, unordered_map nodes) come from one process wide FixedTypeAllocator per node
+    //  type, over a VirtualPool so nodes never move. Arrays (vector storage, hash buckets)
+    //  go to the global heap
+    template<typename Type, uint64_t Size = 1024U>
+    class PoolStlAllocator
+    {
     public:
-        template<typename Type>
-        [[nodiscard]] constexpr auto New() -> OffsetPtr<Type>
+        using value_type = Type;
+        using is_always_equal = std::true_type;
+
+        template<typename Other>
+        struct rebind
         {
-            using PoolType = FixedTypeAllocator<Padding<sizeof(Type)>, PoolSize, Reallocates, ThreadSafe>;
+            using other = PoolStlAllocator<Other, Size>;
+        };
 
-            uint64_t pool = ResolvePool<Type>();
-            auto ftPool = static_cast<PoolType*>(m_Pools[pool]);
+        PoolStlAllocator() noexcept = default;
 
-            return OffsetPtr<Type> ((PoolAllocator*)ftPool, ftPool->Get().Internal());
+        template<typename Other>
+        PoolStlAllocator(const PoolStlAllocator<Other, Size>&) noexcept
+        {
         }
 
-        template<typename Type>
-        constexpr void Delete(OffsetPtr<Type>& oPtr)
+        [[nodiscard]] auto allocate(size_t count) -> Type*
         {
-            using SizedType = Padding<sizeof(Type)>;
-            using PoolType  = FixedTypeAllocator<Padding<sizeof(Type)>, PoolSize, Reallocates, ThreadSafe>;
+            if (count != 1U)
+                return static_cast<Type*>(::operator new(count * sizeof(Type), std::align_val_t(alignof(Type))));
 
-            uint64_t pool = ResolvePool<Type>();
-            auto ftPool = static_cast<PoolType*>(m_Pools[pool]);
+            uint64_t index = 0U;
 
-            // TODO(tomas): not ideal
-            OffsetPtr<SizedType> sized { (PoolAllocator*)ftPool, oPtr.Internal() };
-            ftPool->Pop(sized);
-            oPtr.ZeroOut();
+            if (NodePool().ReserveSlots(&index, 1U) == 0U)
+                throw std::bad_alloc();
+
+            return reinterpret_cast<Type*>(NodePool().Slot(index));
         }
 
-        ~GeneralPurposeAllocator()
+        void deallocate(Type *pElement, size_t count) noexcept
         {
-            for (auto pool : m_Pools)
-                delete pool.second;
+            if (count != 1U)
+            {
+                ::operator delete(pElement, std::align_val_t(alignof(Type)));
+                return;
+            }
+
+            const uint64_t index = static_cast<uint64_t>(reinterpret_cast<Node*>(pElement) - NodePool().Slot(0U));
+            NodePool().ReleaseSlots(&index, 1U);
         }
 
+        template<typename Other>
+        [[nodiscard]] constexpr auto operator==(const PoolStlAllocator<Other, Size>&) const noexcept -> bool { return true; }
+
+        template<typename Other>
+        [[nodiscard]] constexpr auto operator!=(const PoolStlAllocator<Other, Size>&) const noexcept -> bool { return false; }
+
     private:
-        std::map<uint64_t, Allocator*> m_Pools{};
-        std::array<uint64_t, sizeof...(SubPoolSize)> m_SubPoolSizes{};
-        uint64_t m_PoolInitializationCounter = 0U;
+        // Raw storage, the container constructs and destroys the node itself
+        struct alignas(Type) Node
+        {
+            uint8_t bytes[sizeof(Type)];
+        };
+
+        using NodeAllocator = FixedTypeAllocator<Node, Size, AllocatorPolicy<Policies::Reallocating, Policies::Locked, VirtualPool>>;
+
+        // Never destroyed, containers with static storage may still free nodes during exit
+        [[nodiscard]] static auto NodePool() -> NodeAllocator&
+        {
+            static NodeAllocator *pPool = new NodeAllocator();
+            return *pPool;
+        }
     };
 }
 
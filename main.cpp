@@ -1,30 +1,44 @@
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Allocators.h"
 
-template <typename TimeType>
-class Bench
-{
-public:
-    Bench()
-    {
-        m_Start = std::chrono::high_resolution_clock::now();
-    }
-
-    ~Bench()
-    {
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration<float>(end - m_Start);
-        std::cout << std::chrono::duration_cast<TimeType>(duration).count() << std::endl;
-    }
+// Optional third party baselines, the library has to be linked in as well
+#if defined(ALC_BENCH_MIMALLOC)
+#include <mimalloc.h>
+#endif
 
-private:
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_Start{};
-};
+#if defined(ALC_BENCH_JEMALLOC)
+#include <jemalloc/jemalloc.h>
+#endif
 
-void TestFixedTypeAllocator()
+////////////////////////////////////////////////
+// Allocator benchmarks
+//  One CSV row per measurement, to stdout or to the file named by the first argument.
+//  Every sample is nanoseconds per operation, rows are meant to be diffed between runs
+namespace Bench
 {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint64_t PoolSize         = 64U * 1024U;
+    constexpr uint64_t Repetitions      = 15U;
+    constexpr uint64_t LatencySamples   = 5000U;
+    constexpr uint64_t LatencyBatch     = 32U;
+    constexpr uint64_t GpaObjects       = 16U * 1024U;
+    constexpr uint64_t ContentionOps    = 50U * 1024U;
+    constexpr uint64_t ContentionWindow = 16U;
+    constexpr uint64_t ForAllFrames     = 60U;
+
     class Particle
     {
     public:
@@ -37,60 +51,455 @@ void TestFixedTypeAllocator()
         float x, y;
     };
 
-    const auto dt = 1 / 60.f;
-    Alc::FixedTypeAllocator<Particle, 128 K, true> allocator{};
+    template<uint64_t Bytes>
+    struct Blob
+    {
+        uint8_t bytes[Bytes];
+    };
 
-    for (int i = 0; i < 128 K; ++i)
-        allocator.Get()->x = (float)i;
+    // Keeps allocations the optimizer could otherwise prove dead
+    inline volatile uintptr_t g_Sink = 0U;
 
-    std::cout << "Capacity: " << allocator.Internal()->capacity << std::endl;
+    inline void Keep(const void *pMem) noexcept
+    {
+        g_Sink = g_Sink ^ reinterpret_cast<uintptr_t>(pMem);
+    }
 
-    // Smart
-    std::cout << "Smart: ";
+    class Report
     {
-        Bench<std::chrono::milliseconds> b{};
+    public:
+        explicit Report(std::ostream& out)
+            : m_Out(out)
+        {
+            m_Out << "benchmark,allocator,parameter,threads,ops,samples,min_ns,p50_ns,p90_ns,p99_ns,max_ns,mops_per_s\n";
+        }
 
-        for (int i = 0; i < 60; ++i)
+        void Add(const char *benchmark, const std::string& allocator, const std::string& parameter, uint64_t threads, uint64_t ops, std::vector<double> samples)
         {
-            allocator.ForAll([dt](Particle* pParticle) {
-                pParticle->Update(dt);
-            });
+            std::sort(samples.begin(), samples.end());
+
+            const auto percentile = [&samples](double q) { return samples[static_cast<size_t>(q * static_cast<double>(samples.size() - 1U) + 0.5)]; };
+
+            m_Out << benchmark << ',' << allocator << ',' << parameter << ',' << threads << ',' << ops << ',' << samples.size()
+                << std::fixed << std::setprecision(2)
+                << ',' << samples.front() << ',' << percentile(0.5) << ',' << percentile(0.9) << ',' << percentile(0.99) << ',' << samples.back()
+                << ',' << 1000.0 / percentile(0.5) << std::endl;
         }
-    }
 
-    // Fast
-    std::cout << "Fast:";
+    private:
+        std::ostream &m_Out;
+    };
+
+    // body() runs a tenth of the repetitions untimed first, each timed run is one sample
+    template<typename Body>
+    [[nodiscard]] auto Measure(uint64_t repetitions, uint64_t ops, Body&& body) -> std::vector<double>
     {
-        Bench<std::chrono::milliseconds> b{};
+        std::vector<double> samples{};
+        samples.reserve(repetitions);
 
-        for (int i = 0; i < 60; ++i)
+        for (uint64_t i = 0; i < std::max<uint64_t>(repetitions / 10U, 2U); ++i)
+            body();
+
+        for (uint64_t i = 0; i < repetitions; ++i)
         {
-            allocator.ForAll<false>([dt](Particle *pParticle) {
-                pParticle->Update(dt);
-            });
+            const auto start = Clock::now();
+            body();
+            const auto end = Clock::now();
+
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ops));
         }
+
+        return samples;
     }
-}
 
-void TestGeneralPurposeAllocator()
-{
-    Alc::GeneralPurposeAllocator<128U, true, false, 8U, 16U, 32U, 64U, 128U, 256U> gpa{};
+    ////////////////////////////////////////////////
+    // Adapters
+    //  Alloc() / Free(Ptr&) / Address(Ptr&) over every allocator under test
 
-    struct WeirdStruct
+    // FixedTypeAllocator and MagazineAllocator, anything with Get() / Pop()
+    template<typename Type, typename Pool>
+    struct PoolAdapter
     {
-    public:
-        uint8_t internal[48];
+        using Ptr = Alc::OffsetPtr<Type>;
+
+        [[nodiscard]] auto Alloc() -> Ptr { return pool.Get(); }
+        void Free(Ptr& p) { pool.Pop(p); }
+        [[nodiscard]] static auto Address(Ptr& p) -> Type* { return p.Resolve(); }
+
+        Pool pool;
+    };
+
+    using Gpa = Alc::GeneralPurposeAllocator<1024U, true, false, 8U, 16U, 32U, 64U, 128U, 256U>;
+
+    template<typename Type>
+    struct GpaAdapter
+    {
+        using Ptr = Alc::OffsetPtr<Type>;
+
+        [[nodiscard]] auto Alloc() -> Ptr { return gpa.New<Type>(); }
+        void Free(Ptr& p) { gpa.Delete(p); }
+        [[nodiscard]] static auto Address(Ptr& p) -> Type* { return p.Resolve(); }
+
+        Gpa gpa;
+    };
+
+    // Raw memory sources, the adapter builds and destroys the object
+    template<typename Type, typename Source>
+    struct RawAdapter
+    {
+        using Ptr = Type*;
+
+        [[nodiscard]] auto Alloc() -> Ptr { return new (source.Allocate(sizeof(Type), alignof(Type)))Type(); }
+
+        void Free(Ptr& p)
+        {
+            p->~Type();
+            source.Deallocate(p, sizeof(Type), alignof(Type));
+            p = nullptr;
+        }
+
+        [[nodiscard]] static auto Address(Ptr& p) -> Type* { return p; }
+
+        Source source;
+    };
+
+    struct NewSource
+    {
+        [[nodiscard]] auto Allocate(size_t size, size_t) -> void* { return ::operator new(size); }
+        void Deallocate(void *pMem, size_t, size_t) { ::operator delete(pMem); }
+    };
+
+    struct MallocSource
+    {
+        [[nodiscard]] auto Allocate(size_t size, size_t) -> void* { return std::malloc(size); }
+        void Deallocate(void *pMem, size_t, size_t) { std::free(pMem); }
+    };
+
+    template<typename Resource>
+    struct PmrSource
+    {
+        [[nodiscard]] auto Allocate(size_t size, size_t align) -> void* { return resource.allocate(size, align); }
+        void Deallocate(void *pMem, size_t size, size_t align) { resource.deallocate(pMem, size, align); }
+
+        Resource resource;
+    };
+
+    struct GpaHeapSource
+    {
+        [[nodiscard]] auto Allocate(size_t size, size_t align) -> void* { return gpa.Alloc(size, align); }
+        void Deallocate(void *pMem, size_t, size_t) { gpa.Free(pMem); }
+
+        Gpa gpa;
+    };
+
+#if defined(ALC_BENCH_MIMALLOC)
+    struct MimallocSource
+    {
+        [[nodiscard]] auto Allocate(size_t size, size_t align) -> void* { return mi_malloc_aligned(size, align); }
+        void Deallocate(void *pMem, size_t, size_t) { mi_free(pMem); }
     };
+#endif
 
-    for (int i = 0; i < 10; ++i)
+#if defined(ALC_BENCH_JEMALLOC)
+    struct JemallocSource
     {
-        auto n = gpa.New<WeirdStruct>();
-        std::cout << "Internal => " << n.Internal() << " Resolution => " << n.Resolve() << " Container => " << n.Container() << std::endl;
+        [[nodiscard]] auto Allocate(size_t size, size_t align) -> void* { return mallocx(size, MALLOCX_ALIGN(align)); }
+        void Deallocate(void *pMem, size_t, size_t) { dallocx(pMem, 0); }
+    };
+#endif
+
+    template<typename Adapter>
+    struct Tag
+    {
+        using Type = Adapter;
+    };
+
+    // visit(Tag<Adapter>{}, name) for each general purpose baseline
+    template<typename Type, typename Visit>
+    void VisitBaselines(Visit&& visit, bool threadSafe)
+    {
+        visit(Tag<RawAdapter<Type, NewSource>>{}, "new");
+        visit(Tag<RawAdapter<Type, MallocSource>>{}, "malloc");
+
+        if (threadSafe)
+            visit(Tag<RawAdapter<Type, PmrSource<std::pmr::synchronized_pool_resource>>>{}, "pmr_synchronized_pool");
+        else
+            visit(Tag<RawAdapter<Type, PmrSource<std::pmr::unsynchronized_pool_resource>>>{}, "pmr_unsynchronized_pool");
+
+#if defined(ALC_BENCH_MIMALLOC)
+        visit(Tag<RawAdapter<Type, MimallocSource>>{}, "mimalloc");
+#endif
+#if defined(ALC_BENCH_JEMALLOC)
+        visit(Tag<RawAdapter<Type, JemallocSource>>{}, "jemalloc");
+#endif
+    }
+
+    template<typename Type, typename Visit>
+    void VisitSingleThreaded(Visit&& visit)
+    {
+        visit(Tag<PoolAdapter<Type, Alc::FixedTypeAllocator<Type, PoolSize>>>{}, "fta");
+        visit(Tag<PoolAdapter<Type, Alc::FixedTypeAllocator<Type, PoolSize, Alc::AllocatorPolicy<>::WithSlots<Alc::Policies::FreeList>>>>{}, "fta_freelist");
+        visit(Tag<PoolAdapter<Type, Alc::FixedTypeAllocator<Type, PoolSize, Alc::AllocatorPolicy<>::WithSlots<Alc::Policies::Hierarchical>>>>{}, "fta_hierarchical");
+
+        VisitBaselines<Type>(visit, false);
+    }
+
+    template<typename Type, typename Visit>
+    void VisitMultiThreaded(Visit&& visit)
+    {
+        visit(Tag<PoolAdapter<Type, Alc::FixedTypeAllocator<Type, PoolSize, Alc::AllocatorPolicy<>::WithThreading<Alc::Policies::Locked>>>>{}, "fta_locked");
+        visit(Tag<PoolAdapter<Type, Alc::FixedTypeAllocator<Type, PoolSize, Alc::AllocatorPolicy<>::WithThreading<Alc::Policies::LockFree>>>>{}, "fta_lockfree");
+        visit(Tag<PoolAdapter<Type, Alc::MagazineAllocator<Type, 32U, Alc::FixedTypeAllocator<Type, PoolSize, Alc::AllocatorPolicy<Alc::Policies::Reallocating, Alc::Policies::Locked, Alc::VirtualPool>>>>>{}, "magazine");
+
+        VisitBaselines<Type>(visit, true);
+    }
+
+    ////////////////////////////////////////////////
+    // Cases
+
+    // Allocates a full pool, then frees a random share of it so Get() has to look for holes
+    template<typename Adapter>
+    [[nodiscard]] auto Occupy(Adapter& adapter, uint64_t occupancy) -> std::vector<typename Adapter::Ptr>
+    {
+        std::vector<typename Adapter::Ptr> live(PoolSize);
+
+        for (auto &p : live)
+            p = adapter.Alloc();
+
+        std::mt19937_64 rng(42U);
+        std::shuffle(live.begin(), live.end(), rng);
+
+        const uint64_t keep = PoolSize * occupancy / 100U;
+
+        for (uint64_t i = keep; i < PoolSize; ++i)
+            adapter.Free(live[i]);
+
+        live.resize(keep);
+        return live;
+    }
+
+    template<typename Adapter>
+    void GetPopLatency(Report& report, const char *name, uint64_t occupancy)
+    {
+        auto pAdapter = std::make_unique<Adapter>();
+        auto live = Occupy(*pAdapter, occupancy);
+
+        auto samples = Measure(LatencySamples, LatencyBatch, [&]()
+        {
+            for (uint64_t i = 0; i < LatencyBatch; ++i)
+            {
+                auto p = pAdapter->Alloc();
+                Keep(Adapter::Address(p));
+                pAdapter->Free(p);
+            }
+        });
+
+        report.Add("get_pop_latency", name, std::to_string(occupancy) + "%", 1U, LatencyBatch, std::move(samples));
+
+        for (auto &p : live)
+            pAdapter->Free(p);
+    }
+
+    template<typename Adapter>
+    void FillDrain(Report& report, const char *benchmark, const char *name, const std::string& parameter, uint64_t count)
+    {
+        auto pAdapter = std::make_unique<Adapter>();
+        std::vector<typename Adapter::Ptr> live(count);
+
+        auto samples = Measure(Repetitions, count * 2U, [&]()
+        {
+            for (auto &p : live)
+                p = pAdapter->Alloc();
+
+            for (auto &p : live)
+                pAdapter->Free(p);
+        });
+
+        report.Add(benchmark, name, parameter, 1U, count * 2U, std::move(samples));
+    }
+
+    // Smart skips dead slots through the LUT, fast walks every slot up to capacity
+    template<typename Allocator>
+    void ForAllPool(Report& report, const char *name, uint64_t occupancy)
+    {
+        auto pAdapter = std::make_unique<PoolAdapter<Particle, Allocator>>();
+        auto live = Occupy(*pAdapter, occupancy);
+        const float dt = 1 / 60.f;
+
+        // Pools aren't zeroed, the fast walk would otherwise update whatever never handed out
+        //  slots hold (denormals, NaNs) and time that instead
+        for (uint64_t i = 0; i < pAdapter->pool.Internal()->capacity; ++i)
+            *pAdapter->pool.Slot(i) = Particle{};
+
+        report.Add("forall", std::string(name) + "_smart", std::to_string(occupancy) + "%", 1U, live.size() * ForAllFrames,
+            Measure(Repetitions, live.size() * ForAllFrames, [&]()
+            {
+                for (uint64_t i = 0; i < ForAllFrames; ++i)
+                    pAdapter->pool.ForAll([dt](Particle *pParticle) { pParticle->Update(dt); });
+            }));
+
+        report.Add("forall", std::string(name) + "_fast", std::to_string(occupancy) + "%", 1U, live.size() * ForAllFrames,
+            Measure(Repetitions, live.size() * ForAllFrames, [&]()
+            {
+                for (uint64_t i = 0; i < ForAllFrames; ++i)
+                    pAdapter->pool.template ForAll<false>([dt](Particle *pParticle) { pParticle->Update(dt); });
+            }));
+
+        for (auto &p : live)
+            pAdapter->Free(p);
+    }
+
+    // Baselines keep their live objects in a pointer vector and walk that
+    template<typename Adapter>
+    void ForAllPointers(Report& report, const char *name, uint64_t occupancy)
+    {
+        auto pAdapter = std::make_unique<Adapter>();
+        auto live = Occupy(*pAdapter, occupancy);
+        const float dt = 1 / 60.f;
+
+        std::sort(live.begin(), live.end());
+
+        report.Add("forall", name, std::to_string(occupancy) + "%", 1U, live.size() * ForAllFrames,
+            Measure(Repetitions, live.size() * ForAllFrames, [&]()
+            {
+                for (uint64_t i = 0; i < ForAllFrames; ++i)
+                {
+                    for (auto &p : live)
+                        Adapter::Address(p)->Update(dt);
+                }
+            }));
+
+        for (auto &p : live)
+            pAdapter->Free(p);
+    }
+
+    // Every thread keeps a small ring of live objects, freeing the oldest before each Alloc()
+    template<typename Adapter>
+    void Contention(Report& report, const char *name, uint64_t threads)
+    {
+        auto pAdapter = std::make_unique<Adapter>();
+        std::vector<double> samples{};
+
+        for (uint64_t rep = 0; rep < Repetitions + 2U; ++rep)
+        {
+            std::atomic<uint64_t> ready{ 0U };
+            std::atomic<bool> go{ false };
+            std::vector<std::thread> workers{};
+
+            for (uint64_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&]()
+                {
+                    std::vector<typename Adapter::Ptr> ring(ContentionWindow);
+
+                    ready.fetch_add(1U);
+                    while (!go.load(std::memory_order_acquire))
+                        std::this_thread::yield();
+
+                    for (uint64_t i = 0; i < ContentionOps; ++i)
+                    {
+                        auto &p = ring[i % ContentionWindow];
+
+                        if (i >= ContentionWindow)
+                            pAdapter->Free(p);
+
+                        p = pAdapter->Alloc();
+                        Keep(Adapter::Address(p));
+                    }
+
+                    for (auto &p : ring)
+                        pAdapter->Free(p);
+                });
+            }
+
+            while (ready.load() != threads)
+                std::this_thread::yield();
+
+            const auto start = Clock::now();
+            go.store(true, std::memory_order_release);
+
+            for (auto &worker : workers)
+                worker.join();
+
+            const auto end = Clock::now();
+
+            // First two runs are warmup, they also fault in the pools
+            if (rep >= 2U)
+                samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ContentionOps * 2U * threads));
+        }
+
+        report.Add("contention", name, "window_" + std::to_string(ContentionWindow), threads, ContentionOps * 2U * threads, std::move(samples));
+    }
+
+    template<uint64_t Bytes>
+    void GpaSizeClass(Report& report)
+    {
+        using Type = Blob<Bytes>;
+        const std::string parameter = std::to_string(Bytes) + "B";
+
+        const auto run = [&](auto tag, const char *name)
+        {
+            FillDrain<typename decltype(tag)::Type>(report, "gpa_new_delete", name, parameter, GpaObjects);
+        };
+
+        run(Tag<GpaAdapter<Type>>{}, "gpa_new");
+        run(Tag<RawAdapter<Type, GpaHeapSource>>{}, "gpa_heap");
+
+        VisitBaselines<Type>(run, false);
     }
 }
 
-void main()
+int main(int argc, char **argv)
 {
-    TestFixedTypeAllocator();
-    TestGeneralPurposeAllocator();
-}
\ No newline at end of file
+    using namespace Bench;
+
+    std::ofstream file{};
+
+    if (argc > 1)
+        file.open(argv[1]);
+
+    Report report(file.is_open() ? static_cast<std::ostream&>(file) : std::cout);
+
+    for (uint64_t occupancy : { 0U, 50U, 90U, 99U })
+    {
+        VisitSingleThreaded<Particle>([&](auto tag, const char *name)
+        {
+            GetPopLatency<typename decltype(tag)::Type>(report, name, occupancy);
+        });
+    }
+
+    VisitSingleThreaded<Particle>([&](auto tag, const char *name)
+    {
+        FillDrain<typename decltype(tag)::Type>(report, "fill_drain", name, std::to_string(PoolSize), PoolSize);
+    });
+
+    for (uint64_t occupancy : { 100U, 50U, 10U })
+    {
+        ForAllPool<Alc::FixedTypeAllocator<Particle, PoolSize>>(report, "fta", occupancy);
+        ForAllPool<Alc::FixedTypeAllocator<Particle, PoolSize, Alc::AllocatorPolicy<>::WithSlots<Alc::Policies::Hierarchical>>>(report, "fta_hierarchical", occupancy);
+
+        VisitBaselines<Particle>([&](auto tag, const char *name)
+        {
+            ForAllPointers<typename decltype(tag)::Type>(report, name, occupancy);
+        }, false);
+    }
+
+    GpaSizeClass<8U>(report);
+    GpaSizeClass<16U>(report);
+    GpaSizeClass<32U>(report);
+    GpaSizeClass<64U>(report);
+    GpaSizeClass<128U>(report);
+    GpaSizeClass<256U>(report);
+
+    const uint64_t hardwareThreads = std::max<uint64_t>(std::thread::hardware_concurrency(), 1U);
+
+    for (uint64_t threads = 1U; threads <= hardwareThreads; threads *= 2U)
+    {
+        VisitMultiThreaded<Particle>([&](auto tag, const char *name)
+        {
+            Contention<typename decltype(tag)::Type>(report, name, threads);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////
+// File: BackingTests.cpp
+//  Aligned, page and virtual memory backings on their own, and pools placed on pages
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <new>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Vec3 { float a, b, c; };
+
+    void Alignment()
+    {
+        static_assert(AlignedAllocator::NormalizeAlignment(1U) == sizeof(void*));
+        static_assert(AlignedAllocator::NormalizeAlignment(12U) == 16U);
+        static_assert(AlignedAllocator::NormalizeAlignment(64U) == 64U);
+        static_assert(AlignedAllocator::NormalizeAlignment(100U) == 128U);
+
+        for (uint64_t align = 1U; align <= 4096U; align *= 2U)
+        {
+            void *pMem = AlignedAllocator::AllocZeroed(1000U, align);
+            ALC_CHECK(reinterpret_cast<uintptr_t>(pMem) % AlignedAllocator::NormalizeAlignment(align) == 0U);
+            ALC_CHECK(static_cast<uint8_t *>(pMem)[999] == 0U);
+            AlignedAllocator::Dealloc(pMem);
+        }
+    }
+
+    void Pages()
+    {
+        // Explicit huge pages fall back when none are reserved, either way the block is usable
+        const PageOptions huge{ HugePages::Explicit, -1 };
+        const uint64_t bytes = 3U << 20U;
+
+        auto pPages = static_cast<uint8_t *>(PageAllocator::Alloc(bytes, huge));
+        ALC_CHECK(pPages[0] == 0U && pPages[bytes - 1U] == 0U);
+        std::memset(pPages, 1, bytes);
+        PageAllocator::Dealloc(pPages, bytes, huge);
+
+        const uint64_t page = VirtualMemory::PageSize();
+        ALC_CHECK(page > 0U && VirtualMemory::RoundToPage(1U) == page);
+
+        void *pRange = VirtualMemory::Reserve(16U * page);
+        VirtualMemory::Commit(pRange, 4U * page);
+        std::memset(pRange, 2, 4U * page);
+        VirtualMemory::Decommit(pRange, 4U * page);
+        VirtualMemory::Release(pRange, 16U * page);
+    }
+
+    void VirtualPoolGrowsInPlace()
+    {
+        const PageOptions transparent{ HugePages::Transparent, VirtualMemory::CurrentNumaNode() };
+        FixedTypeAllocator<Vec3, 1024U, AllocatorPolicy<>::WithMemory<VirtualPool>> pool(1ULL << 30U, transparent);
+
+        void *pBase = pool.Internal()->pMem;
+        for (int i = 0; i < 100000; ++i)
+            pool.Get()->a = static_cast<float>(i);
+
+        ALC_CHECK(pool.Internal()->pMem == pBase);
+        ALC_CHECK(pool.Internal()->CommittedBytes() >= 100000U * sizeof(Vec3));
+        ALC_CHECK(pool.Slot(99999U)->a == 99999.f);
+    }
+
+    // A reallocating pool past its reservation throws rather than moving
+    void VirtualPoolRunsOut()
+    {
+        const uint64_t reserve = 4U * VirtualMemory::PageSize();
+        FixedTypeAllocator<uint64_t, 8U, AllocatorPolicy<>::WithMemory<VirtualPool>> pool(reserve);
+
+        const uint64_t maxCapacity = pool.Internal()->maxCapacity;
+        for (uint64_t i = 0U; i < maxCapacity; ++i)
+            (void)pool.Get(i);
+
+        ALC_CHECK_THROWS(std::bad_alloc, (void)pool.Get(0U));
+        ALC_CHECK(*pool.Slot(maxCapacity - 1U) == maxCapacity - 1U);
+    }
+
+    void SegmentedPoolKeepsSegments()
+    {
+        FixedTypeAllocator<Vec3, 64U, AllocatorPolicy<>::WithMemory<SegmentedPool>> pool;
+
+        auto first = pool.Get();
+        Vec3 *pFirst = first.Resolve();
+
+        for (int i = 0; i < 5000; ++i)
+            (void)pool.Get();
+
+        ALC_CHECK(first.Resolve() == pFirst);
+        ALC_CHECK(reinterpret_cast<uintptr_t>(pool.Slot(0U)) % AlignedAllocator::CacheLineSize == 0U);
+        ALC_CHECK(pool.Internal()->capacity >= 5001U);
+    }
+
+    // Pool and SegmentedPool blocks placed through PageAllocator, page aligned, across
+    //  growth, compaction and lock free retirement
+    template<typename Pool>
+    void Placed(Pool& pool)
+    {
+        for (int i = 0; i < 5000; ++i)
+            pool.Get()->a = static_cast<float>(i);
+
+        if constexpr (Pool::Backing::Contiguous)
+            ALC_CHECK(reinterpret_cast<uintptr_t>(pool.Internal()->pLut) % VirtualMemory::PageSize() == 0U);
+
+        ALC_CHECK(pool.Slot(4999U)->a == 4999.f && pool.Internal()->capacity >= 5000U);
+    }
+
+    void PlacedPools()
+    {
+        const PageOptions transparent{ HugePages::Transparent, VirtualMemory::CurrentNumaNode() };
+        const PageOptions huge{ HugePages::Explicit, -1 };
+
+        { FixedTypeAllocator<Vec3, 64U> pool(transparent); Placed(pool); }
+        { FixedTypeAllocator<Vec3, 64U, AllocatorPolicy<>::WithMemory<SegmentedPool>> pool(huge); Placed(pool); }
+        { FixedTypeAllocator<Vec3, 64U, AllocatorPolicy<>::WithThreading<Policies::LockFree>> pool(huge); Placed(pool); pool.ReclaimRetired(); }
+
+        // Compact builds its new block with the same options
+        FixedTypeAllocator<Vec3, 64U> pool(transparent);
+        Placed(pool);
+
+        for (uint64_t i = 0U; i < 5000U; i += 2U)
+            (void)pool.Dispose(i, [](Vec3 *) {});
+
+        (void)pool.Compact();
+        ALC_CHECK(pool.Internal()->pageOptions.hugePages == HugePages::Transparent && pool.Internal()->capacity == 2500U);
+    }
+}
+
+int main()
+{
+    ALC_RUN(Alignment);
+    ALC_RUN(Pages);
+    ALC_RUN(VirtualPoolGrowsInPlace);
+    ALC_RUN(VirtualPoolRunsOut);
+    ALC_RUN(SegmentedPoolKeepsSegments);
+    ALC_RUN(PlacedPools);
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+//////////////////////////////////////////////////////////////////////////
+// File: Check.h
+//  Minimal checks for the allocator tests, a failed one reports where
+//  and exits non zero so CTest marks the test as failed
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ALC_TESTS_CHECK_H
+#define ALC_TESTS_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+#define ALC_CHECK(...)                                                                              \
+    do                                                                                              \
+    {                                                                                               \
+        if (!(__VA_ARGS__))                                                                         \
+        {                                                                                           \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__);    \
+            std::exit(EXIT_FAILURE);                                                                \
+        }                                                                                           \
+    } while (false)
+
+#define ALC_CHECK_THROWS(Exception, ...)                                                            \
+    do                                                                                              \
+    {                                                                                               \
+        bool threw = false;                                                                         \
+        try { __VA_ARGS__; } catch (const Exception&) { threw = true; }                             \
+        ALC_CHECK(threw);                                                                           \
+    } while (false)
+
+// Names the case in the CTest log before running it
+#define ALC_RUN(test)                                                                               \
+    do                                                                                              \
+    {                                                                                               \
+        std::printf("%s\n", #test);                                                                 \
+        std::fflush(stdout);                                                                        \
+        test();                                                                                     \
+    } while (false)
+
+#endif
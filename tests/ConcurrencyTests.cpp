@@ -0,0 +1,493 @@
+//////////////////////////////////////////////////////////////////////////
+// File: ConcurrencyTests.cpp
+//  Threaded churn on every thread safe configuration. Each thread stamps what it
+//  allocates and checks the stamp survives, two threads handed the same slot or an
+//  object built outside the lock shows up here and as a race under ThreadSanitizer
+//////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    constexpr int ThreadCount   = 8;
+    constexpr int Operations    = 20000;
+
+    struct Stamp
+    {
+        uint64_t owner = 0U;
+        uint64_t check = ~0ULL;
+
+        Stamp() = default;
+        explicit Stamp(uint64_t id) : owner(id), check(~id) {}
+        ~Stamp() { check = 0U; }
+
+        [[nodiscard]] auto Intact() const -> bool { return check == ~owner; }
+    };
+
+    // Stamp without the destructor, snapshots only take trivially copyable types
+    struct PlainStamp
+    {
+        uint64_t owner = 0U;
+        uint64_t check = ~0ULL;
+
+        PlainStamp() = default;
+        explicit PlainStamp(uint64_t id) : owner(id), check(~id) {}
+
+        [[nodiscard]] auto Intact() const -> bool { return check == ~owner; }
+    };
+
+    template<typename Func>
+    void RunThreads(int count, Func&& func)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < count; ++t)
+            threads.emplace_back(func, static_cast<uint64_t>(t));
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // A pool that reallocates moves objects while other threads keep allocating, only pools
+    //  with stable addresses can be read through a pointer without stopping everyone first
+    template<typename Pool>
+    auto Owned(OffsetPtr<Stamp>& element, uint64_t id) -> bool
+    {
+        if constexpr (Pool::StableAddresses)
+            return element->Intact() && element->owner == id;
+        else
+            return true;
+    }
+
+    // Random Get / Pop mix, every pointer a thread still holds has to carry its stamp
+    template<typename Pool>
+    void Churn(Pool& pool, bool popRemaining = true)
+    {
+        std::atomic<int> failures{ 0 };
+
+        RunThreads(ThreadCount, [&](uint64_t id)
+        {
+            std::vector<OffsetPtr<Stamp>> mine;
+            std::mt19937 rng(static_cast<uint32_t>(id));
+
+            for (int i = 0; i < Operations; ++i)
+            {
+                if (rng() % 3U == 0U && !mine.empty())
+                {
+                    if (!Owned<Pool>(mine.back(), id))
+                        ++failures;
+
+                    pool.Pop(mine.back());
+                    mine.pop_back();
+                }
+                else
+                {
+                    auto element = pool.Get(id);
+                    if (element.Container() == nullptr)
+                        ++failures;
+                    else
+                        mine.push_back(element);
+                }
+            }
+
+            for (auto& element : mine)
+            {
+                if (!Owned<Pool>(element, id))
+                    ++failures;
+
+                if (popRemaining)
+                    pool.Pop(element);
+            }
+        });
+
+        ALC_CHECK(failures.load() == 0);
+
+        uint64_t live = 0U;
+        pool.ForAll([&](Stamp *) { ++live; });
+        ALC_CHECK(live == pool.Internal()->size);
+
+        if (popRemaining)
+            ALC_CHECK(live == 0U);
+    }
+
+    void LockedPools()
+    {
+        using Locked = AllocatorPolicy<>::WithThreading<Policies::Locked>;
+
+        { FixedTypeAllocator<Stamp, 64U, Locked> pool; Churn(pool, false); }
+        { FixedTypeAllocator<Stamp, 64U, Locked::WithSlots<Policies::Hierarchical>> pool; Churn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, Locked::WithSlots<Policies::Dense>> pool; Churn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, Locked::WithMemory<SegmentedPool>> pool; Churn(pool); }
+        { FixedTypeAllocator<Stamp, 1U << 18U, Locked::WithGrowth<Policies::Fixed>> pool; Churn(pool); }
+
+        // Free list links live in dead slots, they must be written before anyone can claim one
+        { FixedTypeAllocator<Stamp, 1U << 18U, Locked::WithGrowth<Policies::Fixed>::WithSlots<Policies::FreeList>> pool; Churn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, Locked::WithMemory<SegmentedPool>::WithSlots<Policies::FreeList>> pool; Churn(pool); }
+    }
+
+    void LockFreePools()
+    {
+        using LockFree = AllocatorPolicy<>::WithThreading<Policies::LockFree>;
+
+        { FixedTypeAllocator<Stamp, 64U, LockFree> pool; Churn(pool, false); ALC_CHECK(pool.Internal()->capacity >= pool.Internal()->size); }
+        { FixedTypeAllocator<Stamp, 1U << 18U, LockFree::WithGrowth<Policies::Fixed>> pool; Churn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, LockFree::WithMemory<SegmentedPool>> pool; Churn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, LockFree::WithMemory<VirtualPool>> pool(1ULL << 30U); Churn(pool); pool.Trim(); }
+    }
+
+    // Queries from another thread take the lock like Get() / Pop() do
+    void LockedQueries()
+    {
+        FixedTypeAllocator<Stamp, 64U, AllocatorPolicy<>::WithThreading<Policies::Locked>::WithMemory<SegmentedPool>> pool;
+        std::atomic<bool> stop{ false };
+
+        std::thread reader([&]
+        {
+            while (!stop.load())
+            {
+                for (uint64_t i = 0U; i < 256U; ++i)
+                    (void)pool.IsActive(i);
+            }
+        });
+
+        Churn(pool);
+        stop.store(true);
+        reader.join();
+    }
+
+    // Early unlock pools build objects outside the lock. A Compact() or Save() racing them
+    //  may only see finished ones, a half built one would come out of the move with a broken
+    //  stamp and shows up as a race on the snapshot write
+    template<typename Element, typename Pool, typename Exclusive>
+    void ExclusiveChurn(Exclusive&& exclusive)
+    {
+        for (int round = 0; round < 20; ++round)
+        {
+            Pool pool;
+
+            for (uint64_t i = 0U; i < 1024U; ++i)
+                (void)pool.Get(Element(i));
+
+            for (uint64_t i = 0U; i < 1024U; i += 2U)
+                ALC_CHECK(pool.Dispose(i, [](Element *pObject) { pObject->~Element(); }));
+
+            std::atomic<int> started{ 0 };
+            std::thread compactor([&]
+            {
+                while (started.load() < ThreadCount / 2)
+                    std::this_thread::yield();
+
+                exclusive(pool);
+            });
+
+            RunThreads(ThreadCount / 2, [&](uint64_t id)
+            {
+                started.fetch_add(1);
+
+                for (int i = 0; i < 256; ++i)
+                {
+                    (void)pool.Emplace([id](Element *pObject)
+                    {
+                        new (pObject)Element(id);
+                        pObject->check = 0U;
+                        std::this_thread::yield();
+                        pObject->check = ~id;
+                    });
+                }
+            });
+
+            compactor.join();
+
+            uint64_t broken = 0U;
+            pool.ForAll([&](Element *pObject) { broken += pObject->Intact() ? 0U : 1U; });
+            ALC_CHECK(broken == 0U && pool.Internal()->size == 512U + (ThreadCount / 2) * 256U);
+        }
+    }
+
+    void ExclusiveWaitsForBuilds()
+    {
+        using Locked = AllocatorPolicy<>::WithThreading<Policies::Locked>;
+
+        const auto compact = [](auto& pool) { (void)pool.Compact(); };
+        ExclusiveChurn<Stamp, FixedTypeAllocator<Stamp, 4096U, Locked::WithGrowth<Policies::Fixed>>>(compact);
+        ExclusiveChurn<Stamp, FixedTypeAllocator<Stamp, 64U, Locked::WithMemory<SegmentedPool>>>(compact);
+
+        const char *pPath = "alc_exclusive.bin";
+        ExclusiveChurn<PlainStamp, FixedTypeAllocator<PlainStamp, 4096U, Locked::WithGrowth<Policies::Fixed>>>([pPath](auto& pool) { pool.Save(pPath); });
+        std::remove(pPath);
+    }
+
+    template<typename Pool>
+    void BatchChurn(Pool& pool)
+    {
+        RunThreads(4, [&](uint64_t id)
+        {
+            for (int round = 0; round < 50; ++round)
+            {
+                std::vector<OffsetPtr<Stamp>> batch;
+                const uint64_t got = pool.GetN(300U, std::back_inserter(batch));
+                ALC_CHECK(got == 300U);
+
+                for (auto& element : batch)
+                {
+                    element->owner = id;
+                    element->check = ~id;
+                }
+
+                for (auto& element : batch)
+                    ALC_CHECK(element->Intact() && element->owner == id);
+
+                pool.PopN(batch);
+            }
+        });
+
+        ALC_CHECK(pool.Internal()->size == 0U);
+    }
+
+    void Batches()
+    {
+        { FixedTypeAllocator<Stamp, 64U, AllocatorPolicy<>::WithThreading<Policies::Locked>::WithMemory<SegmentedPool>> pool; BatchChurn(pool); }
+        { FixedTypeAllocator<Stamp, 1U << 12U, AllocatorPolicy<Policies::Fixed, Policies::Locked>::WithSlots<Policies::FreeList>> pool; BatchChurn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, AllocatorPolicy<>::WithThreading<Policies::LockFree>::WithMemory<SegmentedPool>> pool; BatchChurn(pool); pool.ReclaimRetired(); }
+    }
+
+    // Every thread pops its handle twice, the stale second pop races the slot being reused
+    template<typename Pool>
+    void HandleChurn(Pool& pool)
+    {
+        RunThreads(4, [&](uint64_t id)
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                auto handle = pool.GetHandle(id);
+                auto stale = handle;
+                ALC_CHECK(pool.IsValid(handle));
+                ALC_CHECK(handle->owner == id);
+                pool.Pop(handle);
+                pool.Pop(stale);
+            }
+        });
+
+        ALC_CHECK(pool.Internal()->size == 0U);
+    }
+
+    void Handles()
+    {
+        { FixedTypeAllocator<Stamp, 64U, AllocatorPolicy<Policies::Fixed, Policies::LockFree>> pool; HandleChurn(pool); }
+        { FixedTypeAllocator<Stamp, 64U, AllocatorPolicy<Policies::Fixed, Policies::Locked>> pool; HandleChurn(pool); }
+    }
+
+    // Parked magazines hold reserved slots, everything has to come back to the backing pool
+    template<typename Magazine>
+    void MagazineChurn(Magazine& magazine)
+    {
+        RunThreads(ThreadCount, [&](uint64_t id)
+        {
+            std::vector<OffsetPtr<Stamp>> mine;
+            std::mt19937 rng(static_cast<uint32_t>(id));
+
+            for (int i = 0; i < Operations; ++i)
+            {
+                if ((rng() & 1U) && !mine.empty())
+                {
+                    magazine.Pop(mine.back());
+                    mine.pop_back();
+                }
+                else
+                {
+                    auto element = magazine.Get(id);
+                    ALC_CHECK(element.Container() != nullptr);
+                    mine.push_back(element);
+                }
+            }
+
+            for (auto& element : mine)
+            {
+                ALC_CHECK(element->Intact() && element->owner == id);
+                magazine.Pop(element);
+            }
+        });
+
+        ALC_CHECK(magazine.Internal()->Internal()->size == 0U);
+    }
+
+    void Magazines()
+    {
+        using FixedLockFree = AllocatorPolicy<Policies::Fixed, Policies::LockFree>;
+
+        { MagazineAllocator<Stamp, 16U, FixedTypeAllocator<Stamp, 1U << 16U, FixedLockFree>> magazine; MagazineChurn(magazine); }
+        { MagazineAllocator<Stamp, 16U, FixedTypeAllocator<Stamp, 64U, AllocatorPolicy<>::WithThreading<Policies::LockFree>::WithMemory<SegmentedPool>>> magazine; MagazineChurn(magazine); }
+
+        // A small fixed backing runs dry instead of overcommitting through the magazines
+        MagazineAllocator<Stamp, 4U, FixedTypeAllocator<Stamp, 8U, AllocatorPolicy<Policies::Fixed, Policies::Locked>>> small;
+        std::vector<OffsetPtr<Stamp>> elements;
+        for (int i = 0; i < 10; ++i)
+        {
+            auto element = small.Get();
+            if (element.Container() != nullptr)
+                elements.push_back(element);
+        }
+
+        ALC_CHECK(elements.size() == 8U);
+
+        for (auto& element : elements)
+            small.Pop(element);
+    }
+
+    void GeneralPurpose()
+    {
+        // Fixed sub pools, objects are read outside the lock while others allocate
+        GeneralPurposeAllocator<1U << 14U, false, true, 8U, 16U, 32U> gpa;
+
+        RunThreads(4, [&](uint64_t id)
+        {
+            std::vector<OffsetPtr<Stamp>> mine;
+            for (uint64_t i = 0U; i < 3000U; ++i)
+                mine.push_back(gpa.New<Stamp>(i * 4U + id));
+
+            for (auto& element : mine)
+                ALC_CHECK(element->Intact());
+
+            // The second Delete through a copy finds the slot gone and does nothing
+            for (auto& element : mine)
+            {
+                auto copy = element;
+                gpa.Delete(element);
+                gpa.Delete(copy);
+            }
+        });
+
+        ALC_CHECK(gpa.Stats().subPools[1].live == 0U);
+
+        RunThreads(4, [&](uint64_t)
+        {
+            std::vector<void *> blocks;
+            for (int i = 0; i < 20000; ++i)
+            {
+                blocks.push_back(gpa.Alloc(static_cast<uint64_t>(i % 300 + 1)));
+                if (i & 1)
+                {
+                    gpa.Free(blocks.back());
+                    blocks.pop_back();
+                }
+            }
+
+            for (void *pBlock : blocks)
+                gpa.Free(pBlock);
+        });
+    }
+
+    // Lock free readers walk the pool while writers pop, nothing they see may be destroyed yet
+    void DeferredReclamation()
+    {
+        static std::atomic<long> s_Live{ 0 };
+
+        struct Counted
+        {
+            uint64_t value = 7U;
+            uint64_t check = ~7ULL;
+
+            Counted() { ++s_Live; }
+            ~Counted() { check = 0U; --s_Live; }
+        };
+
+        using Deferred = AllocatorPolicy<>::WithThreading<Policies::LockFree>::WithReclamation<Policies::Deferred>;
+
+        {
+            FixedTypeAllocator<Counted, 128U, Deferred> pool;
+
+            // A reader pinned on the current epoch keeps the popped object alive
+            {
+                EpochDomain::Guard guard;
+                auto element = pool.Get();
+                pool.Pop(element);
+                (void)pool.Collect();
+                ALC_CHECK(s_Live.load() == 1);
+            }
+
+            (void)pool.Collect();
+            ALC_CHECK(s_Live.load() == 0);
+
+            std::atomic<bool> stop{ false };
+            std::atomic<long> torn{ 0 };
+
+            std::vector<std::thread> readers;
+            for (int r = 0; r < 2; ++r)
+            {
+                readers.emplace_back([&]
+                {
+                    while (!stop.load())
+                        pool.ForAll([&](Counted *pObject) { if (pObject->check != ~pObject->value) ++torn; });
+                });
+            }
+
+            RunThreads(3, [&](uint64_t)
+            {
+                std::vector<OffsetPtr<Counted>> elements;
+                for (int i = 0; i < 5000; ++i)
+                {
+                    elements.push_back(pool.Get());
+                    if (elements.size() > 50U)
+                    {
+                        if (i & 1)
+                        {
+                            pool.PopN(elements);
+                        }
+                        else
+                        {
+                            for (auto& element : elements)
+                                pool.Pop(element);
+                        }
+
+                        elements.clear();
+                    }
+                }
+
+                for (auto& element : elements)
+                    pool.Pop(element);
+            });
+
+            stop.store(true);
+            for (auto& reader : readers)
+                reader.join();
+
+            ALC_CHECK(torn.load() == 0);
+            ALC_CHECK(pool.Internal()->size == 0U);
+
+            // Nobody reads any more, everything retired by the churn can go
+            (void)pool.Collect();
+            ALC_CHECK(s_Live.load() == 0);
+
+            // Left retired, the pool destroys it on the way out
+            EpochDomain::Guard guard;
+            auto last = pool.Get();
+            pool.Pop(last);
+            ALC_CHECK(s_Live.load() == 1);
+        }
+
+        ALC_CHECK(s_Live.load() == 0);
+    }
+}
+
+int main()
+{
+    ALC_RUN(LockedPools);
+    ALC_RUN(LockFreePools);
+    ALC_RUN(Batches);
+    ALC_RUN(Handles);
+    ALC_RUN(Magazines);
+    ALC_RUN(LockedQueries);
+    ALC_RUN(ExclusiveWaitsForBuilds);
+    ALC_RUN(GeneralPurpose);
+    ALC_RUN(DeferredReclamation);
+
+    return 0;
+}
@@ -0,0 +1,475 @@
+//////////////////////////////////////////////////////////////////////////
+// File: FixedTypeAllocatorTests.cpp
+//  Single threaded FixedTypeAllocator behaviour for every slot search policy
+//////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Particle
+    {
+        float x = 0.f;
+        float y = 0.f;
+
+        Particle() = default;
+        Particle(float px, float py) : x(px), y(py) {}
+    };
+
+    // Counts live instances so construction and destruction can be checked
+    struct Tracked
+    {
+        static inline int s_Live = 0;
+
+        long long value = 7;
+
+        Tracked() { ++s_Live; }
+        explicit Tracked(long long v) : value(v) { ++s_Live; }
+        Tracked(Tracked&& other) noexcept : value(other.value) { ++s_Live; }
+        ~Tracked() { --s_Live; }
+    };
+
+    // Default construction throws once s_Budget runs out
+    struct Fragile
+    {
+        static inline int s_Live   = 0;
+        static inline int s_Budget = 0;
+
+        long long value = 3;
+
+        Fragile()
+        {
+            if (s_Budget-- == 0)
+                throw std::runtime_error("Fragile");
+
+            ++s_Live;
+        }
+
+        ~Fragile() { --s_Live; }
+    };
+
+    template<typename Pool>
+    auto CountLive(Pool& pool) -> uint64_t
+    {
+        uint64_t count = 0U;
+        pool.ForAll([&](auto *) { ++count; });
+        return count;
+    }
+
+    template<typename Pool>
+    void PopAll(Pool& pool)
+    {
+        for (uint64_t i = 0U; i < pool.Internal()->capacity; ++i)
+        {
+            if (pool.IsActive(i))
+            {
+                OffsetPtr<typename std::remove_pointer_t<decltype(pool.Slot(0U))>> element(pool.Internal(), i);
+                pool.Pop(element);
+            }
+        }
+    }
+
+    // Fill, pop every other one, refill and churn, the LUT and size have to agree throughout
+    template<typename Pool>
+    void GetPopRefill(Pool& pool, int count)
+    {
+        std::vector<OffsetPtr<Particle>> elements;
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto element = pool.Get(static_cast<float>(i), 0.f);
+            ALC_CHECK(element.Container() != nullptr);
+            elements.push_back(element);
+        }
+
+        ALC_CHECK(pool.Internal()->size == static_cast<uint64_t>(count));
+
+        for (int i = 0; i < count; i += 2)
+            pool.Pop(elements[i]);
+
+        uint64_t odd = 0U;
+        pool.ForAll([&](Particle *p) { ++odd; ALC_CHECK(static_cast<int>(p->x) % 2 == 1); });
+        ALC_CHECK(odd == static_cast<uint64_t>(count / 2));
+
+        for (int i = 0; i < count / 2; ++i)
+            (void)pool.Get();
+
+        ALC_CHECK(CountLive(pool) == static_cast<uint64_t>(count));
+
+        std::vector<OffsetPtr<Particle>> live;
+        for (uint64_t i = 0U; i < pool.Internal()->capacity; ++i)
+            if (pool.IsActive(i))
+                live.emplace_back(pool.Internal(), i);
+
+        std::mt19937 rng(1U);
+        for (int i = 0; i < 20000; ++i)
+        {
+            if ((rng() & 1U) && !live.empty())
+            {
+                const size_t pick = rng() % live.size();
+                pool.Pop(live[pick]);
+                live[pick] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                live.push_back(pool.Get());
+            }
+        }
+
+        ALC_CHECK(CountLive(pool) == live.size());
+        ALC_CHECK(pool.Internal()->size == live.size());
+    }
+
+    void SlotSearchPolicies()
+    {
+        { FixedTypeAllocator<Particle, 10U> pool; GetPopRefill(pool, 1000); ALC_CHECK(pool.Internal()->capacity >= 1000U); }
+        { FixedTypeAllocator<Particle, 64U, AllocatorPolicy<>::WithSlots<Policies::FreeList>> pool; GetPopRefill(pool, 1000); }
+        { FixedTypeAllocator<Particle, 10U, AllocatorPolicy<>::WithSlots<Policies::Hierarchical>> pool; GetPopRefill(pool, 1000); }
+        { FixedTypeAllocator<Particle, 64U, AllocatorPolicy<>::WithSlots<Policies::Dense>> pool; GetPopRefill(pool, 3000); }
+        { FixedTypeAllocator<Particle, 100U, AllocatorPolicy<>::WithSlots<Policies::Slots<true, true, false>>> pool; GetPopRefill(pool, 5000); }
+    }
+
+    void Backings()
+    {
+        { FixedTypeAllocator<Particle, 100U, AllocatorPolicy<>::WithMemory<SegmentedPool>> pool; GetPopRefill(pool, 5000); }
+        { FixedTypeAllocator<Particle, 64U, AllocatorPolicy<>::WithMemory<VirtualPool>> pool; GetPopRefill(pool, 5000); }
+    }
+
+    void GrowthKeepsValues()
+    {
+        FixedTypeAllocator<Particle, 10U> pool;
+
+        std::vector<OffsetPtr<Particle>> elements;
+        for (int i = 0; i < 1000; ++i)
+            elements.push_back(pool.Get(static_cast<float>(i), 1.f));
+
+        ALC_CHECK(pool.Internal()->capacity == 1280U);
+
+        for (int i = 0; i < 1000; ++i)
+            ALC_CHECK(elements[i]->x == static_cast<float>(i) && elements[i]->y == 1.f);
+
+        // Not skipping inactive slots visits the whole capacity
+        uint64_t visited = 0U;
+        pool.ForAll<false>([&](Particle *) { ++visited; });
+        ALC_CHECK(visited == pool.Internal()->capacity);
+    }
+
+    void FixedCapacityRunsOut()
+    {
+        FixedTypeAllocator<Particle, 64U, AllocatorPolicy<>::WithGrowth<Policies::Fixed>> pool;
+
+        for (int i = 0; i < 64; ++i)
+            ALC_CHECK(pool.Get().Container() != nullptr);
+
+        ALC_CHECK(pool.Get().Container() == nullptr);
+        ALC_CHECK(pool.Internal()->capacity == 64U);
+    }
+
+    void StableAddresses()
+    {
+        static_assert(!FixedTypeAllocator<Particle>::StableAddresses);
+        static_assert(FixedTypeAllocator<Particle, 64U, AllocatorPolicy<>::WithMemory<SegmentedPool>>::StableAddresses);
+        static_assert(FixedTypeAllocator<Particle, 64U, AllocatorPolicy<>::WithGrowth<Policies::Fixed>>::StableAddresses);
+
+        FixedTypeAllocator<std::string, 64U, AllocatorPolicy<>::WithMemory<SegmentedPool>> pool;
+
+        std::vector<OffsetPtr<std::string>> elements;
+        std::vector<std::string *> addresses;
+        for (int i = 0; i < 3000; ++i)
+        {
+            auto element = pool.Get(100U, static_cast<char>('a' + i % 26));
+            elements.push_back(element);
+            addresses.push_back(element.Resolve());
+        }
+
+        for (int i = 0; i < 3000; ++i)
+        {
+            ALC_CHECK(elements[i].Resolve() == addresses[i]);
+            ALC_CHECK((*elements[i].Resolve())[5] == 'a' + i % 26);
+            pool.Pop(elements[i]);
+        }
+    }
+
+    void ConstructsAndDestroys()
+    {
+        {
+            FixedTypeAllocator<Tracked, 4U> pool;
+
+            auto a = pool.Get(3LL);
+            auto b = pool.Get();
+            ALC_CHECK(a->value == 3 && b->value == 7);
+            ALC_CHECK(Tracked::s_Live == 2);
+
+            auto stale = a;
+            pool.Pop(a);
+            ALC_CHECK(Tracked::s_Live == 1);
+            ALC_CHECK(a.Container() == nullptr);
+
+            // A second pop through a copy finds the slot inactive and leaves it alone
+            pool.Pop(stale);
+            ALC_CHECK(Tracked::s_Live == 1 && pool.Internal()->size == 1U);
+
+            // A cleared pointer belongs to no pool
+            ALC_CHECK_THROWS(std::out_of_range, pool.Pop(a));
+
+            pool.Pop(b);
+            ALC_CHECK(Tracked::s_Live == 0 && pool.Internal()->size == 0U);
+        }
+    }
+
+    void EmplaceAndDispose()
+    {
+        FixedTypeAllocator<Tracked, 4U> pool;
+
+        auto element = pool.Emplace([](Tracked *pObject) { new (pObject)Tracked(11); });
+        ALC_CHECK(element->value == 11 && Tracked::s_Live == 1);
+
+        const uint64_t index = element.Internal();
+        ALC_CHECK(pool.Dispose(index, [](Tracked *pObject) { pObject->~Tracked(); }));
+        ALC_CHECK(Tracked::s_Live == 0 && !pool.IsActive(index));
+
+        // A slot that is no longer live is left alone
+        ALC_CHECK(!pool.Dispose(index, [](Tracked *pObject) { pObject->~Tracked(); }));
+        ALC_CHECK(Tracked::s_Live == 0 && pool.Internal()->size == 0U);
+    }
+
+    template<typename Pool>
+    void Unwinds(Pool& pool)
+    {
+        const auto threw = [](auto&& get)
+        {
+            try
+            {
+                get();
+            }
+            catch (const std::runtime_error&)
+            {
+                return true;
+            }
+
+            return false;
+        };
+
+        Fragile::s_Budget = 0;
+        ALC_CHECK(threw([&]() { (void)pool.Emplace([](Fragile *pObject) { new (pObject)Fragile(); }); }));
+        ALC_CHECK(pool.Internal()->size == 0U && !pool.IsActive(0U) && CountLive(pool) == 0U);
+
+        // A throw half way through a batch, past the first growth, leaves nothing behind
+        std::vector<OffsetPtr<Fragile>> elements;
+        Fragile::s_Budget = 150;
+        ALC_CHECK(threw([&]() { (void)pool.GetN(200U, std::back_inserter(elements)); }));
+        ALC_CHECK(elements.empty() && Fragile::s_Live == 0 && pool.Internal()->size == 0U);
+
+        // Every slot handed back is usable again
+        Fragile::s_Budget = 1000;
+        ALC_CHECK(pool.GetN(200U, std::back_inserter(elements)) == 200U && CountLive(pool) == 200U);
+        pool.PopN(elements);
+        ALC_CHECK(Fragile::s_Live == 0 && pool.Internal()->size == 0U);
+    }
+
+    void ThrowingConstructors()
+    {
+        { FixedTypeAllocator<Fragile, 64U> pool; Unwinds(pool); }
+        { FixedTypeAllocator<Fragile, 64U, AllocatorPolicy<>::WithSlots<Policies::FreeList>> pool; Unwinds(pool); }
+        { FixedTypeAllocator<Fragile, 64U, AllocatorPolicy<>::WithSlots<Policies::Dense>> pool; Unwinds(pool); }
+        { FixedTypeAllocator<Fragile, 64U, AllocatorPolicy<>::WithThreading<Policies::Locked>> pool; Unwinds(pool); }
+        { FixedTypeAllocator<Fragile, 64U, AllocatorPolicy<>::WithThreading<Policies::Locked>::WithMemory<SegmentedPool>> pool; Unwinds(pool); }
+        { FixedTypeAllocator<Fragile, 64U, AllocatorPolicy<>::WithThreading<Policies::LockFree>> pool; Unwinds(pool); }
+    }
+
+    template<typename Pool>
+    void Batches(Pool& pool)
+    {
+        std::vector<OffsetPtr<Tracked>> elements;
+        ALC_CHECK(pool.GetN(5000U, std::back_inserter(elements)) == 5000U);
+
+        for (auto& element : elements)
+            ALC_CHECK(element->value == 7);
+
+        // Duplicates are only popped once
+        elements.push_back(elements[3]);
+        pool.PopN(elements);
+        elements.pop_back();
+
+        for (auto& element : elements)
+            ALC_CHECK(element.Container() == nullptr);
+
+        ALC_CHECK(CountLive(pool) == 0U && Tracked::s_Live == 0);
+    }
+
+    void GetNPopN()
+    {
+        { FixedTypeAllocator<Tracked> pool; Batches(pool); }
+        { FixedTypeAllocator<Tracked, 64U, AllocatorPolicy<>::WithSlots<Policies::FreeList>> pool; Batches(pool); }
+        { FixedTypeAllocator<Tracked, 64U, AllocatorPolicy<>::WithSlots<Policies::Dense>> pool; Batches(pool); }
+
+        // A fixed pool hands out what it has
+        FixedTypeAllocator<Tracked, 64U, AllocatorPolicy<>::WithGrowth<Policies::Fixed>> fixed;
+        std::vector<OffsetPtr<Tracked>> elements;
+        ALC_CHECK(fixed.GetN(100U, std::back_inserter(elements)) == 64U);
+        fixed.PopN(elements);
+    }
+
+    void ReserveAndRelease()
+    {
+        uint64_t indices[300];
+
+        {
+            FixedTypeAllocator<Particle, 100U, AllocatorPolicy<>::WithSlots<Policies::Hierarchical>> pool;
+            ALC_CHECK(pool.ReserveSlots(indices, 300U) == 300U);
+            ALC_CHECK(pool.Internal()->capacity == 400U);
+
+            pool.ReleaseSlots(indices, 150U);
+            ALC_CHECK(pool.Internal()->size == 150U && CountLive(pool) == 150U);
+        }
+
+        {
+            FixedTypeAllocator<Particle, 100U, AllocatorPolicy<>::WithSlots<Policies::FreeList>> pool;
+            ALC_CHECK(pool.ReserveSlots(indices, 300U) == 300U);
+            pool.ReleaseSlots(indices, 150U);
+            ALC_CHECK(pool.ReserveSlots(indices, 10U) == 10U);
+            ALC_CHECK(pool.Internal()->size == 160U);
+        }
+    }
+
+    // Growing a Pool relocates with memcpy, the payload sits behind a pointer so that stays valid
+    using Owned = std::unique_ptr<uint64_t>;
+
+    template<typename Pool>
+    void CompactKeeps(Pool& pool)
+    {
+        std::vector<OffsetPtr<Owned>> elements;
+        for (uint64_t i = 0U; i < 5000U; ++i)
+            elements.push_back(pool.Get(std::make_unique<uint64_t>(i)));
+
+        std::vector<OffsetPtr<Owned>> kept;
+        std::vector<uint64_t> ids;
+        for (uint64_t i = 0U; i < 5000U; ++i)
+        {
+            if (i % 10U == 0U)
+            {
+                kept.push_back(elements[i]);
+                ids.push_back(i);
+            }
+            else
+            {
+                pool.Pop(elements[i]);
+            }
+        }
+
+        auto relocations = pool.Compact();
+        relocations.Apply(kept.begin(), kept.end());
+
+        ALC_CHECK(pool.Internal()->size == kept.size());
+        ALC_CHECK(!relocations.Relocations().empty());
+
+        for (size_t i = 0; i < kept.size(); ++i)
+        {
+            ALC_CHECK(kept[i].Internal() < kept.size());
+            ALC_CHECK(**kept[i].Resolve() == ids[i]);
+        }
+
+        for (int i = 0; i < 3000; ++i)
+            (void)pool.Get(std::make_unique<uint64_t>(0U));
+
+        ALC_CHECK(CountLive(pool) == kept.size() + 3000U);
+
+        // The pool does not destroy what is still live
+        PopAll(pool);
+    }
+
+    void Compact()
+    {
+        { FixedTypeAllocator<Owned, 64U> pool; CompactKeeps(pool); }
+        { FixedTypeAllocator<Owned, 64U, AllocatorPolicy<>::WithSlots<Policies::Dense>> pool; CompactKeeps(pool); }
+        { FixedTypeAllocator<Owned, 64U, AllocatorPolicy<>::WithSlots<Policies::Hierarchical>::WithMemory<SegmentedPool>> pool; CompactKeeps(pool); }
+        { FixedTypeAllocator<Owned, 64U, AllocatorPolicy<>::WithSlots<Policies::FreeList>::WithMemory<SegmentedPool>> pool; CompactKeeps(pool); }
+        { FixedTypeAllocator<Owned, 64U, AllocatorPolicy<>::WithThreading<Policies::LockFree>::WithMemory<VirtualPool>> pool; CompactKeeps(pool); }
+    }
+
+    void TrimVirtualPool()
+    {
+        FixedTypeAllocator<Particle, 1000U, AllocatorPolicy<>::WithSlots<Policies::Hierarchical>::WithMemory<VirtualPool>> pool;
+        void *pBase = pool.Internal()->pMem;
+
+        std::vector<OffsetPtr<Particle>> elements;
+        for (int i = 0; i < 200000; ++i)
+            elements.push_back(pool.Get(static_cast<float>(i), 0.f));
+
+        // Growing in place never moves the reservation
+        ALC_CHECK(pool.Internal()->pMem == pBase);
+        const uint64_t committed = pool.Internal()->CommittedBytes();
+
+        for (int i = 1000; i < 200000; ++i)
+            pool.Pop(elements[i]);
+
+        pool.Trim();
+        ALC_CHECK(pool.Internal()->CommittedBytes() < committed);
+
+        int next = 0;
+        pool.ForAll([&](Particle *p) { ALC_CHECK(p->x == static_cast<float>(next)); ++next; });
+        ALC_CHECK(next == 1000);
+    }
+
+    void CacheAlignedSlots()
+    {
+        static_assert(sizeof(CacheAligned<Particle>) == AlignedAllocator::CacheLineSize);
+
+        FixedTypeAllocator<CacheAligned<Particle>, 16U> pool;
+        for (int i = 0; i < 100; ++i)
+        {
+            auto element = pool.Get();
+            ALC_CHECK(reinterpret_cast<uintptr_t>(element.Resolve()) % AlignedAllocator::CacheLineSize == 0U);
+        }
+    }
+
+    void ParallelVisitsOnce()
+    {
+        struct Counter { int hits = 0; };
+
+        ThreadPoolExecutor executor(4U);
+        FixedTypeAllocator<Counter, 1000U> pool;
+
+        std::vector<OffsetPtr<Counter>> elements;
+        for (int i = 0; i < 20000; ++i)
+            elements.push_back(pool.Get());
+
+        for (int i = 0; i < 20000; i += 7)
+            pool.Pop(elements[i]);
+
+        for (int round = 0; round < 20; ++round)
+            pool.ForAllParallel([](Counter *c) { ++c->hits; }, executor);
+
+        pool.ForAll([](Counter *c) { ALC_CHECK(c->hits == 20); });
+    }
+}
+
+int main()
+{
+    ALC_RUN(SlotSearchPolicies);
+    ALC_RUN(Backings);
+    ALC_RUN(GrowthKeepsValues);
+    ALC_RUN(FixedCapacityRunsOut);
+    ALC_RUN(StableAddresses);
+    ALC_RUN(ConstructsAndDestroys);
+    ALC_RUN(EmplaceAndDispose);
+    ALC_RUN(ThrowingConstructors);
+    ALC_RUN(GetNPopN);
+    ALC_RUN(ReserveAndRelease);
+    ALC_RUN(Compact);
+    ALC_RUN(TrimVirtualPool);
+    ALC_RUN(CacheAlignedSlots);
+    ALC_RUN(ParallelVisitsOnce);
+
+    return 0;
+}
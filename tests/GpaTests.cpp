@@ -0,0 +1,230 @@
+//////////////////////////////////////////////////////////////////////////
+// File: GpaTests.cpp
+//  GeneralPurposeAllocator sub pools and runtime heap, size classes and the
+//  std adapters built on them
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Small { int a = 0; };
+    struct Weird { uint8_t bytes[48]; };
+    struct Big { uint8_t bytes[300]; };
+
+    struct Counted
+    {
+        static inline int s_Live = 0;
+
+        uint64_t value;
+        uint64_t check;
+
+        explicit Counted(uint64_t v) : value(v), check(~v) { ++s_Live; }
+        ~Counted() { --s_Live; }
+    };
+
+    using Gpa = GeneralPurposeAllocator<128U, true, false, 8U, 16U, 32U, 64U, 128U, 256U>;
+
+    void PicksSizeClasses()
+    {
+        static_assert(Gpa::SizeClass<Small>() == 0U);
+        static_assert(Gpa::SizeClass<Counted>() == 1U);
+        static_assert(Gpa::SizeClass<Weird>() == 3U);
+        static_assert(Gpa::SizeClass<Big>() == Gpa::SubPoolCount);
+    }
+
+    // Every size lands in the smallest class that holds it
+    void SizeClassTable()
+    {
+        for (uint64_t size = 1U; size <= SizeClasses::MaxSize; ++size)
+        {
+            const uint64_t index = SizeClasses::Index(size);
+            ALC_CHECK(SizeClasses::Sizes[index] >= size);
+            ALC_CHECK(index == 0U || SizeClasses::Sizes[index - 1U] < size);
+        }
+    }
+
+    void NewAndDelete()
+    {
+        Gpa gpa;
+
+        std::vector<OffsetPtr<Weird>> weird;
+        for (int i = 0; i < 300; ++i)
+        {
+            auto element = gpa.New<Weird>();
+            element->bytes[0] = static_cast<uint8_t>(i);
+            element->bytes[47] = static_cast<uint8_t>(i);
+            weird.push_back(element);
+        }
+
+        // The sub pool grew, every object kept its own bytes
+        for (int i = 0; i < 300; ++i)
+            ALC_CHECK(weird[i]->bytes[0] == static_cast<uint8_t>(i) && weird[i]->bytes[47] == static_cast<uint8_t>(i));
+
+        for (auto& element : weird)
+            gpa.Delete(element);
+
+        std::vector<OffsetPtr<Counted>> counted;
+        for (uint64_t i = 0U; i < 100U; ++i)
+            counted.push_back(gpa.New<Counted>(i));
+
+        ALC_CHECK(Counted::s_Live == 100);
+
+        for (uint64_t i = 0U; i < 100U; ++i)
+            ALC_CHECK(counted[i]->value == i && counted[i]->check == ~i);
+
+        for (auto& element : counted)
+        {
+            auto copy = element;
+            gpa.Delete(element);
+            ALC_CHECK(element.Container() == nullptr);
+
+            // Already destroyed, the copy must not destroy it again
+            gpa.Delete(copy);
+        }
+
+        ALC_CHECK(Counted::s_Live == 0);
+    }
+
+    void FixedRunsOut()
+    {
+        GeneralPurposeAllocator<2U, false, false, 64U> gpa;
+
+        auto a = gpa.New<Weird>();
+        auto b = gpa.New<Weird>();
+        auto c = gpa.New<Weird>();
+
+        ALC_CHECK(a.Container() != nullptr && b.Container() != nullptr);
+        ALC_CHECK(c.Container() == nullptr);
+
+        gpa.Delete(a);
+        ALC_CHECK(gpa.New<Weird>().Container() != nullptr);
+    }
+
+    void PolicyDriven()
+    {
+        BasicGeneralPurposeAllocator<AllocatorPolicy<Policies::Fixed, Policies::Locked>, 64U, 8U, 16U, 32U> gpa;
+
+        auto element = gpa.New<Small>();
+        element->a = 3;
+        ALC_CHECK(element->a == 3);
+        gpa.Delete(element);
+
+        void *pBlock = gpa.Alloc(40U);
+        ALC_CHECK(pBlock != nullptr);
+        gpa.Free(pBlock);
+    }
+
+    void RuntimeHeap()
+    {
+        GeneralPurposeAllocator<128U, true, true, 8U> gpa;
+
+        std::mt19937 rng(1U);
+        std::vector<std::pair<uint8_t *, size_t>> live;
+
+        for (int i = 0; i < 50000; ++i)
+        {
+            if (live.empty() || rng() % 3U)
+            {
+                const size_t size = rng() % (rng() % 10U == 0U ? 70000U : 600U);
+                const size_t align = size_t(1U) << (rng() % 8U);
+
+                auto pBlock = static_cast<uint8_t *>(gpa.Alloc(size, align));
+                ALC_CHECK(reinterpret_cast<uintptr_t>(pBlock) % align == 0U);
+                ALC_CHECK(SlabHeap<true>::UsableSize(pBlock) >= size);
+
+                std::memset(pBlock, 0xAB, size);
+                live.emplace_back(pBlock, size);
+            }
+            else
+            {
+                const size_t pick = rng() % live.size();
+                gpa.Free(live[pick].first);
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        }
+
+        for (auto& block : live)
+            gpa.Free(block.first);
+    }
+
+    void MemoryResource()
+    {
+        GeneralPurposeAllocator<128U, true, false, 8U> gpa;
+        GpaMemoryResource<decltype(gpa)> resource(gpa);
+
+        std::pmr::vector<std::pmr::string> strings(&resource);
+        for (int i = 0; i < 1000; ++i)
+            strings.emplace_back(std::string(50, 'x') + std::to_string(i));
+
+        ALC_CHECK(strings[999].compare(std::string(50, 'x') + "999") == 0);
+
+        std::pmr::unordered_map<int, int> map(&resource);
+        for (int i = 0; i < 10000; ++i)
+            map[i] = i * 2;
+
+        ALC_CHECK(map.size() == 10000U && map[77] == 154);
+
+        GpaMemoryResource<decltype(gpa)> same(gpa);
+        ALC_CHECK(resource.is_equal(same));
+        ALC_CHECK(!resource.is_equal(*std::pmr::new_delete_resource()));
+    }
+
+    void StlAdapter()
+    {
+        std::list<int, PoolStlAllocator<int>> list;
+        for (int i = 0; i < 10000; ++i)
+            list.push_back(i);
+
+        long long sum = 0;
+        for (int value : list)
+            sum += value;
+
+        ALC_CHECK(sum == 49995000LL);
+
+        for (int i = 0; i < 5000; ++i)
+            list.pop_front();
+
+        ALC_CHECK(list.front() == 5000);
+
+        std::map<int, std::string, std::less<int>, PoolStlAllocator<std::pair<const int, std::string>>> map;
+        for (int i = 0; i < 3000; ++i)
+            map[i] = std::to_string(i);
+
+        ALC_CHECK(map[1234] == "1234");
+
+        std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, PoolStlAllocator<std::pair<const int, int>>> hashed;
+        for (int i = 0; i < 5000; ++i)
+            hashed[i] = i * 2;
+
+        ALC_CHECK(hashed[77] == 154);
+    }
+}
+
+int main()
+{
+    ALC_RUN(PicksSizeClasses);
+    ALC_RUN(SizeClassTable);
+    ALC_RUN(NewAndDelete);
+    ALC_RUN(FixedRunsOut);
+    ALC_RUN(PolicyDriven);
+    ALC_RUN(RuntimeHeap);
+    ALC_RUN(MemoryResource);
+    ALC_RUN(StlAdapter);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////////
+// File: HandleTests.cpp
+//  Handle generations, stale handles and resolving across growth
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdexcept>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Value
+    {
+        int a = 0;
+        int b = 0;
+    };
+
+    static_assert(sizeof(Handle<Value>) == 8U);
+
+    template<typename Pool>
+    void ResolveAcrossGrowth(Pool& pool)
+    {
+        std::vector<Handle<Value>> handles;
+        for (int i = 0; i < 100; ++i)
+        {
+            auto handle = pool.GetHandle();
+            handle->a = i;
+            handles.push_back(handle);
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+            ALC_CHECK(pool.IsValid(handles[i]));
+            ALC_CHECK(handles[i]->a == i);
+        }
+
+        pool.Pop(handles[5]);
+        ALC_CHECK(handles[5].PoolId() == HandleTable::InvalidPool);
+
+        for (auto& handle : handles)
+            pool.Pop(handle);
+
+        ALC_CHECK(pool.Internal()->size == 0U);
+    }
+
+    void Growth()
+    {
+        { FixedTypeAllocator<Value, 4U> pool; ResolveAcrossGrowth(pool); }
+        { FixedTypeAllocator<Value, 4U, AllocatorPolicy<>::WithMemory<VirtualPool>> pool; ResolveAcrossGrowth(pool); }
+        { FixedTypeAllocator<Value, 4U, AllocatorPolicy<>::WithThreading<Policies::LockFree>> pool; ResolveAcrossGrowth(pool); }
+    }
+
+    void StaleHandles()
+    {
+        FixedTypeAllocator<Value, 4U> pool;
+
+        auto handle = pool.GetHandle();
+        auto copy = handle;
+        pool.Pop(handle);
+
+        // The slot comes straight back, under a new generation
+        auto reused = pool.GetHandle();
+        ALC_CHECK(reused.Internal() == copy.Internal());
+        ALC_CHECK(reused.Generation() != copy.Generation());
+        ALC_CHECK(!pool.IsValid(copy) && pool.IsValid(reused));
+
+        if constexpr (CheckHandles)
+            ALC_CHECK_THROWS(std::out_of_range, (void)copy.Resolve());
+
+        // Popping through the stale copy must not free the new owner's slot
+        pool.Pop(copy);
+        ALC_CHECK(pool.IsValid(reused) && pool.Internal()->size == 1U);
+
+        ALC_CHECK(!pool.IsValid(Handle<Value>{}));
+    }
+
+    void ConvertsToOffsetPtr()
+    {
+        FixedTypeAllocator<Value, 16U> pool;
+
+        auto element = pool.Get();
+        element->b = 42;
+
+        auto handle = pool.ToHandle(element);
+        ALC_CHECK(pool.IsValid(handle) && handle->b == 42);
+
+        auto back = pool.ToOffsetPtr(handle);
+        ALC_CHECK(back.Internal() == element.Internal());
+
+        pool.Pop(element);
+        ALC_CHECK(!pool.IsValid(handle));
+    }
+
+    void ReleasesPoolIds()
+    {
+        // Pool ids go back to the table with the pool, far more pools than ids can come and go
+        for (uint32_t i = 0U; i < 2U * HandleTable::MaxPools; ++i)
+        {
+            FixedTypeAllocator<Value, 4U> pool;
+            auto handle = pool.GetHandle();
+            ALC_CHECK(pool.IsValid(handle));
+        }
+    }
+}
+
+int main()
+{
+    ALC_RUN(Growth);
+    ALC_RUN(StaleHandles);
+    ALC_RUN(ConvertsToOffsetPtr);
+    ALC_RUN(ReleasesPoolIds);
+
+    return 0;
+}
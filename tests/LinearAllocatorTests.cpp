@@ -0,0 +1,153 @@
+//////////////////////////////////////////////////////////////////////////
+// File: LinearAllocatorTests.cpp
+//  Arena, frame arena, stack and double ended stack allocators
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <new>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Value
+    {
+        double a;
+        int b;
+
+        explicit Value(int v) : a(v), b(v) {}
+    };
+
+    auto IsAligned(const void *pMem, uint64_t align) -> bool
+    {
+        return reinterpret_cast<uintptr_t>(pMem) % align == 0U;
+    }
+
+    void Arena()
+    {
+        ArenaAllocator arena(4096U);
+        const auto start = arena.GetMarker();
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            auto pValue = arena.New<Value>(i);
+            ALC_CHECK(pValue->b == i && IsAligned(pValue, alignof(Value)));
+        }
+
+        // Larger than a block, gets one of its own
+        void *pBig = arena.Alloc(100000U, 256U);
+        ALC_CHECK(IsAligned(pBig, 256U));
+        std::memset(pBig, 1, 100000U);
+
+        // Reset keeps the blocks, the same pass reserves nothing new
+        const uint64_t reserved = arena.Reserved();
+        arena.Reset();
+        for (int i = 0; i < 10000; ++i)
+            (void)arena.New<Value>(i);
+
+        ALC_CHECK(arena.Reserved() == reserved);
+
+        {
+            ArenaAllocator::Scope scope(arena);
+            for (int i = 0; i < 10000; ++i)
+                (void)arena.Alloc(16U);
+        }
+
+        auto pArray = arena.NewArray<int>(100U);
+        for (int i = 0; i < 100; ++i)
+            ALC_CHECK(pArray[i] == 0);
+
+        arena.Rewind(start);
+        ALC_CHECK(arena.Alloc(8U) != nullptr);
+    }
+
+    void FrameRotation()
+    {
+        FrameArena<> frames;
+
+        auto pPrevious = frames.New<Value>(3);
+        frames.NextFrame();
+        auto pCurrent = frames.New<Value>(4);
+
+        // Last frame's data is still readable for one frame
+        ALC_CHECK(pPrevious->b == 3 && pCurrent->b == 4);
+
+        frames.NextFrame();
+        frames.NextFrame();
+        ALC_CHECK(frames.New<Value>(5)->b == 5);
+    }
+
+    void Stack()
+    {
+        StackAllocator stack(1U << 16U);
+        const auto marker = stack.GetMarker();
+
+        auto pValue = stack.New<Value>(3);
+        auto pArray = stack.NewArray<int>(10U);
+        ALC_CHECK(pValue->b == 3 && pArray[3] == 0);
+        ALC_CHECK(stack.Used() > 0U);
+
+        stack.FreeToMarker(marker);
+        ALC_CHECK(stack.Used() == 0U);
+
+        ALC_CHECK_THROWS(std::bad_alloc, (void)stack.Alloc(1U << 17U));
+    }
+
+    void DoubleEndedStack()
+    {
+        DoubleEndedStackAllocator stack(1024U);
+        const uint64_t empty = stack.Free();
+
+        auto pBottom = stack.New<Value>(1);
+        const auto topMarker = stack.GetMarker<StackEnd::Top>();
+        auto pTop = stack.New<Value, StackEnd::Top>(2);
+
+        ALC_CHECK(pBottom->b == 1 && pTop->b == 2);
+        ALC_CHECK(IsAligned(pTop, alignof(Value)));
+        ALC_CHECK(reinterpret_cast<uint8_t *>(pBottom) < reinterpret_cast<uint8_t *>(pTop));
+
+        const uint64_t bothUsed = stack.Free();
+        stack.FreeToMarker<StackEnd::Top>(topMarker);
+        ALC_CHECK(stack.Free() > bothUsed);
+
+        // The two ends meet instead of overlapping
+        ALC_CHECK_THROWS(std::bad_alloc, for (;;) (void)stack.Alloc<StackEnd::Top>(100U, 64U));
+        ALC_CHECK(stack.Free() < 100U + 64U);
+
+        stack.Clear<StackEnd::Top>();
+        stack.Clear();
+        ALC_CHECK(stack.Free() == empty);
+    }
+
+    // Alignment is of the address, past the cache line alignment the blocks come with
+    void LargeAlignments()
+    {
+        ArenaAllocator arena(4096U);
+        StackAllocator stack(1U << 18U);
+        DoubleEndedStackAllocator doubleEnded(1U << 18U);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const uint64_t align = 1ULL << (i % 10);
+
+            ALC_CHECK(IsAligned(arena.Alloc(8U + i % 13U, align), align));
+            ALC_CHECK(IsAligned(stack.Alloc(8U, align), align));
+            ALC_CHECK(IsAligned(doubleEnded.Alloc(8U, align), align));
+            ALC_CHECK(IsAligned(doubleEnded.Alloc<StackEnd::Top>(8U, align), align));
+        }
+    }
+}
+
+int main()
+{
+    ALC_RUN(Arena);
+    ALC_RUN(FrameRotation);
+    ALC_RUN(Stack);
+    ALC_RUN(DoubleEndedStack);
+    ALC_RUN(LargeAlignments);
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+//////////////////////////////////////////////////////////////////////////
+// File: PolicyTests.cpp
+//  AllocatorPolicy composition and the fixed size allocator's class pools
+//////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    // Runs before main. The class pool is constant initialized, usable here whatever the order
+    //  and never rebuilt once dynamic initialization gets to it, the element stays live
+    const uint64_t g_StaticCapacity = []
+    {
+        (void)Fsa::GetAllocator<24U>()->Get();
+        return Fsa::GetAllocator<24U>()->Internal()->capacity;
+    }();
+
+    struct Value { int a; float b; };
+
+    using Default   = AllocatorPolicy<>;
+    using Composed  = Default::WithThreading<Policies::LockFree>::WithMemory<VirtualPool>::WithCounting<Policies::WithStats>;
+
+    static_assert(Default::Reallocates && !Default::ThreadSafe && !Default::LockFree);
+    static_assert(!Default::FreeList && !Default::Hierarchical && !Default::Dense && !Default::Deferred);
+    static_assert(std::is_same_v<Default::Backing, Pool>);
+
+    static_assert(Composed::Reallocates && Composed::ThreadSafe && Composed::LockFree && Composed::Stats);
+    static_assert(std::is_same_v<Composed::Backing, VirtualPool>);
+    static_assert(std::is_same_v<Composed::WithThreading<Policies::SingleThreaded>::WithMemory<Pool>::WithCounting<Policies::DefaultStats>, Default>);
+
+    static_assert(Default::WithSlots<Policies::FreeList>::FreeList);
+    static_assert(Default::WithSlots<Policies::Hierarchical>::Hierarchical);
+    static_assert(Default::WithSlots<Policies::Dense>::Dense);
+    static_assert(Default::WithReclamation<Policies::Deferred>::Deferred);
+    static_assert(!Default::WithGrowth<Policies::Fixed>::Reallocates);
+    static_assert(Policies::Locked::ThreadSafe && !Policies::Locked::LockFree);
+
+    // The allocator re-exposes what it was given
+    using Pooled = FixedTypeAllocator<Value, 256U, Composed>;
+    static_assert(Pooled::LockFree && Pooled::Counted && std::is_same_v<Pooled::Backing, VirtualPool>);
+    static_assert(Pooled::StableAddresses);
+
+    // Bool spellings from before policies land on the same allocator
+    static_assert(std::is_same_v<FlagFixedTypeAllocator<Value>, FixedTypeAllocator<Value>>);
+    static_assert(std::is_same_v<FlagFixedTypeAllocator<Value, 64U, false, true>,
+                                 FixedTypeAllocator<Value, 64U, Default::WithGrowth<Policies::Fixed>::WithThreading<Policies::Locked>>>);
+    static_assert(std::is_same_v<FlagFixedTypeAllocator<Value, 64U, true, false, true, false, false, SegmentedPool, false, true>,
+                                 FixedTypeAllocator<Value, 64U, Default::WithMemory<SegmentedPool>::WithSlots<Policies::FreeList>::WithReclamation<Policies::Deferred>>>);
+    static_assert(FlagFixedTypeAllocator<Value, 64U, true, false, false, false, true>::LockFree);
+
+    void ComposedPolicy()
+    {
+        Pooled pool;
+        auto element = pool.Get();
+        element->a = 5;
+
+        const AllocatorStats stats = pool.Stats();
+        ALC_CHECK(stats.allocations == 1U && stats.live == 1U);
+
+        pool.Pop(element);
+    }
+
+    // Built Unallocated, the first Get() or GetN() takes the block the constructor would have
+    template<typename Pool>
+    void StartsUnallocated()
+    {
+        Pool pool{ Unallocated{} };
+        ALC_CHECK(pool.Internal()->capacity == 0U && !pool.IsActive(0U));
+
+        auto element = pool.Get();
+        ALC_CHECK(pool.Internal()->capacity == 64U && pool.IsActive(element.Internal()));
+
+        std::vector<OffsetPtr<Value>> elements;
+        const uint64_t expected = Pool::Reallocates ? 100U : 63U;
+        ALC_CHECK(pool.GetN(100U, std::back_inserter(elements)) == expected);
+
+        pool.PopN(elements);
+        pool.Pop(element);
+        ALC_CHECK(pool.Stats().live == 0U);
+
+        // Batches may be the first to allocate too
+        Pool batched{ Unallocated{} };
+        elements.clear();
+        ALC_CHECK(batched.GetN(10U, std::back_inserter(elements)) == 10U && batched.Internal()->capacity == 64U);
+        batched.PopN(elements);
+    }
+
+    void UnallocatedPools()
+    {
+        StartsUnallocated<FixedTypeAllocator<Value, 64U>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithGrowth<Policies::Fixed>>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithThreading<Policies::Locked>>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithSlots<Policies::FreeList>>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithSlots<Policies::Hierarchical>>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithSlots<Policies::Dense>>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithThreading<Policies::LockFree>>>();
+        StartsUnallocated<FixedTypeAllocator<Value, 64U, Default::WithThreading<Policies::LockFree>::WithReclamation<Policies::Deferred>>>();
+
+        static_assert(!FixedTypeAllocator<Value, 64U, Default::WithMemory<SegmentedPool>>::ConstantInitializable);
+        static_assert(!FixedTypeAllocator<Value, 64U, Default::WithGrowth<Policies::Fixed>::WithThreading<Policies::LockFree>>::ConstantInitializable);
+    }
+
+    void FsaClasses()
+    {
+        static_assert(Fsa::ClassSize<13U>() == 16U && Fsa::ClassSize<16U>() == 16U);
+        static_assert(Fsa::ClassSize<17U>() == 32U);
+        static_assert(Fsa::ClassSize<20000U>() == 20000U);
+
+        // Sizes rounding up to the same class share one pool
+        ALC_CHECK(Fsa::GetPool<13U>() == Fsa::GetPool<16U>());
+        ALC_CHECK(Fsa::GetPool<13U>() != Fsa::GetPool<17U>());
+        ALC_CHECK(Fsa::GetPool<13U>()->poolItemSize == 16U);
+
+        static_assert(Fsa::SizedPool<24U>::ConstantInitializable);
+        ALC_CHECK(g_StaticCapacity == 1024U && Fsa::GetPool<24U>()->capacity == 1024U && Fsa::Stats<24U>().live == 1U);
+
+        // Raw callers get an allocated pool without a Get()
+        ALC_CHECK(Fsa::GetPool<48U>()->capacity == 1024U && Fsa::GetPool<48U>()->Lut() != nullptr);
+    }
+
+    void LockedFsa()
+    {
+        using LockedFsa = BasicFsa<AllocatorPolicy<Policies::Reallocating, Policies::Locked>>;
+
+        auto pAllocator = LockedFsa::GetAllocator<24U>();
+        const auto churn = [pAllocator]
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                auto element = pAllocator->Get();
+                pAllocator->Pop(element);
+            }
+        };
+
+        std::thread first(churn);
+        std::thread second(churn);
+        first.join();
+        second.join();
+
+        ALC_CHECK(LockedFsa::Stats<24U>().live == 0U);
+
+        // Its own pools, not the single threaded Fsa's
+        ALC_CHECK(static_cast<void *>(LockedFsa::GetPool<24U>()) != static_cast<void *>(Fsa::GetPool<24U>()));
+    }
+}
+
+int main()
+{
+    ALC_RUN(ComposedPolicy);
+    ALC_RUN(UnallocatedPools);
+    ALC_RUN(FsaClasses);
+    ALC_RUN(LockedFsa);
+
+    return 0;
+}
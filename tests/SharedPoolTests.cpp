@@ -0,0 +1,196 @@
+//////////////////////////////////////////////////////////////////////////
+// File: SharedPoolTests.cpp
+//  Pools shared between forked processes, POSIX only. Segment names carry the
+//  pid so parallel runs don't meet
+//////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Message
+    {
+        uint64_t id;
+        float value;
+    };
+
+    using Shared = FixedTypeAllocator<Message, 4096U, AllocatorPolicy<Policies::Fixed, Policies::LockFree, SharedPool>>;
+
+    auto SegmentName(const char *pTag) -> std::string
+    {
+        return std::string("/alc_") + pTag + "_" + std::to_string(getpid());
+    }
+
+    // Exit codes of every child, 0 each when they all succeeded
+    auto WaitChildren(int count) -> int
+    {
+        int failed = 0;
+
+        for (int i = 0; i < count; ++i)
+        {
+            int status = 0;
+            if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                ++failed;
+        }
+
+        return failed;
+    }
+
+    void HandlesAcrossProcesses()
+    {
+        const std::string name = SegmentName("handles");
+        SharedPool::Unlink(name.c_str());
+
+        // Handles are handed to the children through anonymous shared memory
+        struct Exchange
+        {
+            Handle<Message> handles[100];
+            std::atomic<int> validated;
+        };
+
+        auto pExchange = static_cast<Exchange *>(mmap(nullptr, sizeof(Exchange), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+        ALC_CHECK(pExchange != MAP_FAILED);
+
+        Handle<Message> *pHandles = pExchange->handles;
+        new (&pExchange->validated) std::atomic<int>(0);
+
+        {
+            Shared pool(name.c_str(), 7U);
+            for (uint64_t i = 0U; i < 100U; ++i)
+                pHandles[i] = pool.GetHandle(Message{ i, 1.f });
+
+            constexpr int Children = 4;
+            for (int child = 0; child < Children; ++child)
+            {
+                if (fork() != 0)
+                    continue;
+
+                // The parent's registration came along with fork, attach as a fresh process would
+                HandleTable::Release(HandleTable::FirstSharedPool + 7U);
+                Shared attached(name.c_str(), 7U);
+
+                bool valid = true;
+                uint64_t sum = 0U;
+                for (uint64_t i = 0U; i < 100U; ++i)
+                {
+                    valid = valid && attached.IsValid(pHandles[i]);
+                    sum += valid ? pHandles[i]->id : 0U;
+                }
+
+                // Counted either way, child 0 must not wait on a sibling that gave up
+                pExchange->validated.fetch_add(1);
+
+                if (!valid || sum != 4950U)
+                    _exit(2);
+
+                for (int round = 0; round < 1000; ++round)
+                {
+                    std::vector<OffsetPtr<Message>> batch;
+                    (void)attached.GetN(5U, std::back_inserter(batch));
+                    attached.PopN(batch);
+                }
+
+                // Everyone has checked handle 5 before it goes stale
+                if (child == 0)
+                {
+                    while (pExchange->validated.load() != Children)
+                        std::this_thread::yield();
+
+                    auto handle = pHandles[5];
+                    attached.Pop(handle);
+                }
+
+                _exit(0);
+            }
+
+            ALC_CHECK(WaitChildren(Children) == 0);
+
+            // One child popped handle 5, everyone else only churned
+            ALC_CHECK(pool.Internal()->size == 99U);
+            ALC_CHECK(!pool.IsValid(pHandles[5]) && pool.IsValid(pHandles[6]));
+
+            // A segment id is one pool, another id can't claim the same segment
+            ALC_CHECK_THROWS(std::runtime_error, Shared wrong(name.c_str(), 8U));
+            ALC_CHECK_THROWS(std::out_of_range, Shared again(name.c_str(), 7U));
+        }
+
+        munmap(pExchange, sizeof(Exchange));
+        SharedPool::Unlink(name.c_str());
+    }
+
+    // Racing creators agree on one layout, a differing capacity is refused
+    void RacingCreators()
+    {
+        const std::string name = SegmentName("race");
+        constexpr int Children = 6;
+
+        for (int round = 0; round < 10; ++round)
+        {
+            SharedPool::Unlink(name.c_str());
+
+            for (int child = 0; child < Children; ++child)
+            {
+                if (fork() != 0)
+                    continue;
+
+                try
+                {
+                    SharedPool pool(16U, 1024U, name.c_str(), 1U);
+                    _exit(pool.capacity == 1024U ? 0 : 4);
+                }
+                catch (const std::runtime_error&)
+                {
+                    _exit(5);
+                }
+            }
+
+            ALC_CHECK(WaitChildren(Children) == 0);
+            ALC_CHECK_THROWS(std::runtime_error, SharedPool(16U, 512U, name.c_str(), 1U));
+        }
+
+        SharedPool::Unlink(name.c_str());
+    }
+
+    void SharedDescriptor()
+    {
+        char path[] = "alc_shared_XXXXXX";
+        const int fd = mkstemp(path);
+        ALC_CHECK(fd >= 0);
+        unlink(path);
+
+        {
+            SharedPool first(16U, 64U, fd, 3U);
+            SharedPool second(16U, 64U, fd, 3U);
+
+            first.size = 5U;
+            ALC_CHECK(second.size == 5U);
+
+            ALC_CHECK_THROWS(std::runtime_error, SharedPool(16U, 128U, fd, 3U));
+        }
+
+        close(fd);
+    }
+}
+
+int main()
+{
+    ALC_RUN(HandlesAcrossProcesses);
+    ALC_RUN(RacingCreators);
+    ALC_RUN(SharedDescriptor);
+
+    return 0;
+}
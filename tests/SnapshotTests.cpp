@@ -0,0 +1,186 @@
+//////////////////////////////////////////////////////////////////////////
+// File: SnapshotTests.cpp
+//  Saving pools, mapping them back in and rejecting files that don't fit.
+//  Files are written to the working directory
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Entity
+    {
+        uint64_t id;
+        float x;
+        float y;
+    };
+
+    using Mapped        = FixedTypeAllocator<Entity, 64U, AllocatorPolicy<Policies::Fixed>::WithSlots<Policies::Hierarchical>::WithMemory<MappedPool>>;
+    using MappedLocked  = FixedTypeAllocator<Entity, 256U, AllocatorPolicy<Policies::Fixed, Policies::Locked, MappedPool>>;
+
+    auto SumIds(Mapped& pool, uint64_t& count) -> uint64_t
+    {
+        uint64_t sum = 0U;
+        count = 0U;
+        pool.ForAll([&](Entity *pEntity) { sum += pEntity->id; ++count; });
+        return sum;
+    }
+
+    void RoundTrip()
+    {
+        const char *pPath = "alc_snapshot.bin";
+        std::remove(pPath);
+
+        uint64_t expected = 0U;
+        {
+            FixedTypeAllocator<Entity, 64U> pool;
+
+            std::vector<OffsetPtr<Entity>> elements;
+            for (uint64_t i = 0U; i < 300U; ++i)
+                elements.push_back(pool.Get(Entity{ i, 1.f, 2.f }));
+
+            for (uint64_t i = 0U; i < 300U; i += 3U)
+                pool.Pop(elements[i]);
+
+            for (uint64_t i = 0U; i < 300U; ++i)
+                expected += (i % 3U) ? i : 0U;
+
+            pool.Save(pPath);
+        }
+
+        {
+            Mapped pool(pPath, MapMode::CopyOnWrite);
+
+            uint64_t count = 0U;
+            ALC_CHECK(SumIds(pool, count) == expected && count == 200U);
+            ALC_CHECK(pool.Internal()->size == 200U && pool.Internal()->capacity == 512U);
+
+            // Private write, the file keeps what was saved
+            (void)pool.Get(Entity{ 999U, 0.f, 0.f });
+            ALC_CHECK(pool.Stats().fragmentation > 0.0);
+        }
+
+        {
+            Mapped pool(pPath, MapMode::CopyOnWrite);
+
+            uint64_t count = 0U;
+            ALC_CHECK(SumIds(pool, count) == expected && count == 200U);
+        }
+
+        // A different element size is not this pool's snapshot
+        ALC_CHECK_THROWS(std::runtime_error, FixedTypeAllocator<uint32_t, 64U, AllocatorPolicy<Policies::Fixed, Policies::SingleThreaded, MappedPool>> wrong(pPath));
+
+        std::remove(pPath);
+    }
+
+    void SharedWritesPersist()
+    {
+        const char *pPath = "alc_live.bin";
+        std::remove(pPath);
+
+        {
+            // A missing file starts out as an empty pool of the requested capacity
+            MappedLocked pool(pPath);
+            ALC_CHECK(pool.Internal()->capacity == 256U && pool.Internal()->size == 0U);
+
+            for (uint64_t i = 0U; i < 10U; ++i)
+                (void)pool.Get(Entity{ i, 0.f, 0.f });
+
+            std::vector<OffsetPtr<Entity>> elements;
+            ALC_CHECK(pool.GetN(300U, std::back_inserter(elements)) == 246U);
+        }
+
+        {
+            MappedLocked pool(pPath);
+            ALC_CHECK(pool.Internal()->size == 256U);
+            ALC_CHECK(pool.Slot(3U)->id == 3U);
+        }
+
+        std::remove(pPath);
+    }
+
+    template<typename Edit>
+    void CorruptHeader(const char *pPath, Edit&& edit)
+    {
+        std::FILE *pFile = std::fopen(pPath, "r+b");
+        ALC_CHECK(pFile != nullptr);
+
+        SnapshotHeader header{};
+        ALC_CHECK(std::fread(&header, sizeof(header), 1U, pFile) == 1U);
+        edit(header);
+
+        std::fseek(pFile, 0, SEEK_SET);
+        ALC_CHECK(std::fwrite(&header, sizeof(header), 1U, pFile) == 1U);
+        std::fclose(pFile);
+    }
+
+    void RejectsCorruptFiles()
+    {
+        const char *pPath = "alc_corrupt.bin";
+        std::remove(pPath);
+
+        {
+            FixedTypeAllocator<uint64_t, 1024U, AllocatorPolicy<Policies::Fixed>> pool;
+            for (uint64_t i = 0U; i < 500U; ++i)
+                (void)pool.Get(i);
+
+            pool.Save(pPath);
+        }
+
+        {
+            MappedPool pool(sizeof(uint64_t), 1024U, pPath);
+            ALC_CHECK(pool.capacity == 1024U && pool.size == 500U);
+        }
+
+        // Capacity far past what the file holds
+        CorruptHeader(pPath, [](SnapshotHeader& header) { header.capacity = 1ULL << 40U; });
+        ALC_CHECK_THROWS(std::runtime_error, MappedPool(sizeof(uint64_t), 1024U, pPath));
+
+        // Objects placed outside the file
+        CorruptHeader(pPath, [](SnapshotHeader& header) { header.capacity = 1024U; header.memOffset = 1ULL << 50U; });
+        ALC_CHECK_THROWS(std::runtime_error, MappedPool(sizeof(uint64_t), 1024U, pPath));
+
+        // Header back in order but the file cut short
+        CorruptHeader(pPath, [](SnapshotHeader& header) { header.memOffset = SnapshotHeader::Layout(sizeof(uint64_t), 1024U, 0U).memOffset; });
+        std::filesystem::resize_file(pPath, 8192U);
+        ALC_CHECK_THROWS(std::runtime_error, MappedPool(sizeof(uint64_t), 1024U, pPath));
+
+        std::remove(pPath);
+    }
+
+    void FixedSizeClass()
+    {
+        const char *pPath = "alc_fsa.bin";
+        std::remove(pPath);
+
+        auto pAllocator = Fsa::GetAllocator<32U>();
+        auto element = pAllocator->Get();
+        Fsa::Save<32U>(pPath);
+        pAllocator->Pop(element);
+
+        {
+            MappedPool pool(Fsa::ClassSize<32U>(), 1024U, pPath, MapMode::CopyOnWrite);
+            ALC_CHECK(pool.size == 1U && pool.capacity == Fsa::GetPool<32U>()->capacity);
+        }
+
+        std::remove(pPath);
+    }
+}
+
+int main()
+{
+    ALC_RUN(RoundTrip);
+    ALC_RUN(SharedWritesPersist);
+    ALC_RUN(RejectsCorruptFiles);
+    ALC_RUN(FixedSizeClass);
+
+    return 0;
+}
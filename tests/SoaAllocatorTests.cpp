@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////
+// File: SoaAllocatorTests.cpp
+//  Structure of arrays streams, shared indices and block iteration
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdexcept>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    using Particles = SoaAllocator<100U, true, float, float, int>;
+
+    void StreamsShareIndices()
+    {
+        Particles soa;
+
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < 1000; ++i)
+        {
+            const uint64_t id = soa.Get();
+            ALC_CHECK(soa.Field<0>(id) == 0.f && soa.Field<1>(id) == 0.f && soa.Field<2>(id) == 0);
+
+            soa.Field<0>(id) = static_cast<float>(i);
+            soa.Field<2>(id) = i;
+            ids.push_back(id);
+        }
+
+        ALC_CHECK(soa.Count() == 1000U && soa.Capacity() >= 1000U);
+
+        // Growth kept every stream in step
+        for (int i = 0; i < 1000; ++i)
+            ALC_CHECK(soa.Field<0>(ids[i]) == static_cast<float>(i) && soa.Field<2>(ids[i]) == i);
+
+        for (int i = 0; i < 1000; i += 2)
+            soa.Pop(ids[i]);
+
+        ALC_CHECK(soa.Count() == 500U);
+        ALC_CHECK(!soa.IsActive(ids[0]) && soa.IsActive(ids[1]));
+
+        long long sum = 0;
+        soa.ForAll([&](float& x, float& y, int& k) { sum += k; y = x + 1.f; });
+        ALC_CHECK(sum == 250000LL);
+
+        for (int i = 1; i < 1000; i += 2)
+            ALC_CHECK(soa.Field<1>(ids[i]) == static_cast<float>(i) + 1.f);
+
+        ALC_CHECK_THROWS(std::out_of_range, soa.Pop(soa.Capacity()));
+    }
+
+    void Blocks()
+    {
+        Particles soa;
+        for (int i = 0; i < 200; ++i)
+            soa.Field<2>(soa.Get()) = 1;
+
+        soa.Pop(130U);
+
+        uint64_t blocks = 0U;
+        uint64_t full = 0U;
+        uint64_t lanes = 0U;
+
+        soa.ForEachBlock([&](const Particles::Block& block)
+        {
+            ++blocks;
+            full += block.Full() ? 1U : 0U;
+            lanes += Bits::PopCount(block.mask);
+
+            ALC_CHECK(reinterpret_cast<uintptr_t>(block.Stream<2>() - block.first) % Particles::StreamAlignment == 0U);
+
+            // Padded to whole blocks, every lane can be touched
+            for (uint64_t lane = 0U; lane < Bits::WordBits; ++lane)
+                block.Stream<1>()[lane] += static_cast<float>(block.Stream<2>()[lane]);
+        });
+
+        ALC_CHECK(blocks == 4U && full == 2U && lanes == 199U);
+    }
+
+    void FixedRunsOut()
+    {
+        SoaAllocator<3U, false, double> soa;
+
+        ALC_CHECK(soa.Get() == 0U && soa.Get() == 1U && soa.Get() == 2U);
+        ALC_CHECK(soa.Get() == decltype(soa)::InvalidIndex);
+
+        soa.Pop(1U);
+        ALC_CHECK(soa.Get() == 1U);
+    }
+}
+
+int main()
+{
+    ALC_RUN(StreamsShareIndices);
+    ALC_RUN(Blocks);
+    ALC_RUN(FixedRunsOut);
+
+    return 0;
+}
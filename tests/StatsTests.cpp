@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////
+// File: StatsTests.cpp
+//  Pool and heap counters, with the counting policy on and off
+//////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Allocators.h"
+#include "Check.h"
+
+namespace
+{
+    using namespace Alc;
+
+    struct Value { long long v = 7; };
+
+    using Counting  = AllocatorPolicy<>::WithCounting<Policies::WithStats>;
+    using Silent    = AllocatorPolicy<>::WithCounting<Policies::NoStats>;
+
+    void Counters()
+    {
+        FixedTypeAllocator<Value, 64U, Counting> pool;
+
+        std::vector<OffsetPtr<Value>> elements;
+        for (int i = 0; i < 200; ++i)
+            elements.push_back(pool.Get());
+
+        for (int i = 0; i < 200; i += 2)
+            pool.Pop(elements[i]);
+
+        const AllocatorStats stats = pool.Stats();
+        ALC_CHECK(stats.live == 100U && stats.peak == 200U);
+        ALC_CHECK(stats.allocations == 200U && stats.frees == 100U);
+        ALC_CHECK(stats.reallocations == 2U && stats.capacity == 256U);
+        ALC_CHECK(stats.fragmentation > 0.4 && stats.fragmentation < 0.6);
+
+        std::map<std::string, double> exported;
+        stats.Export([&](const char *pName, auto value) { exported[pName] = static_cast<double>(value); });
+        ALC_CHECK(exported.size() == 10U);
+        ALC_CHECK(exported["live"] == 100.0 && exported["allocations"] == 200.0);
+
+        FixedTypeAllocator<Value, 4U, Counting::WithGrowth<Policies::Fixed>> fixed;
+        for (int i = 0; i < 5; ++i)
+            (void)fixed.Get();
+
+        ALC_CHECK(fixed.Stats().failedAllocations == 1U);
+    }
+
+    void LockFreeCounters()
+    {
+        FixedTypeAllocator<Value, 64U, Counting::WithThreading<Policies::LockFree>> pool;
+
+        std::vector<OffsetPtr<Value>> elements;
+        ALC_CHECK(pool.GetN(500U, std::back_inserter(elements)) == 500U);
+        pool.PopN(elements);
+
+        const AllocatorStats stats = pool.Stats();
+        ALC_CHECK(stats.live == 0U && stats.peak == 500U);
+        ALC_CHECK(stats.allocations == 500U && stats.frees == 500U);
+    }
+
+    // Live and capacity come from the pool, the counters stay zero
+    void Disabled()
+    {
+        FixedTypeAllocator<Value, 64U, Silent> pool;
+        auto element = pool.Get();
+        (void)pool.Get();
+        pool.Pop(element);
+
+        const AllocatorStats stats = pool.Stats();
+        ALC_CHECK(stats.live == 1U && stats.capacity == 64U);
+        ALC_CHECK(stats.allocations == 0U && stats.frees == 0U);
+
+        static_assert(sizeof(FixedTypeAllocator<Value, 64U, Silent>) < sizeof(FixedTypeAllocator<Value, 64U, Counting>));
+        static_assert(sizeof(SlabHeap<false, false>) < sizeof(SlabHeap<false, true>));
+    }
+
+    void HeapCounters()
+    {
+        BasicGeneralPurposeAllocator<Counting::WithThreading<Policies::Locked>, 128U, 8U, 16U, 32U> gpa;
+
+        auto element = gpa.New<Value>();
+        void *pBlock = gpa.Alloc(100U);
+        gpa.Free(pBlock);
+
+        const auto stats = gpa.Stats();
+        ALC_CHECK(stats.subPools[0].live == 1U && stats.subPools[0].allocations == 1U);
+        ALC_CHECK(stats.heap[SizeClasses::Index(100U)].allocations == 1U);
+        ALC_CHECK(stats.heap[SizeClasses::Index(100U)].frees == 1U);
+
+        gpa.Delete(element);
+        ALC_CHECK(gpa.Stats().subPools[0].live == 0U);
+
+        SlabHeap<true, false> silent;
+        silent.Free(silent.Alloc(20U));
+        ALC_CHECK(silent.Stats()[SizeClasses::Index(20U)].allocations == 0U);
+    }
+}
+
+int main()
+{
+    ALC_RUN(Counters);
+    ALC_RUN(LockFreeCounters);
+    ALC_RUN(Disabled);
+    ALC_RUN(HeapCounters);
+
+    return 0;
+}